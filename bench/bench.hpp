@@ -0,0 +1,110 @@
+////////////////////////////////////////////////////////////////////////////////
+//! @file
+//! Minimal micro benchmark harness.
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace yama {
+namespace bench {
+
+////////////////////////////////////////////////////////////////////////////////
+//! The timing result of a single benchmark case.
+////////////////////////////////////////////////////////////////////////////////
+struct result {
+    std::string name;
+    size_t      iterations; //!< The number of timed repetitions.
+    size_t      items;      //!< Items processed per repetition.
+    double      best;       //!< Fastest repetition in seconds.
+    double      median;     //!< Median repetition in seconds.
+    double      p99;        //!< 99th percentile repetition in seconds.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Passed to each benchmark; times cases and collects the results.
+////////////////////////////////////////////////////////////////////////////////
+class context {
+public:
+    using clock = std::chrono::high_resolution_clock;
+
+    explicit context(double min_time = 0.25, size_t min_iterations = 3);
+
+    ////////////////////////////////////////////////////////////////////////////
+    //! Repeatedly time @p function until both the minimum time and the minimum
+    //! number of iterations have been reached.
+    //!
+    //! @param name The name of the case.
+    //! @param items The number of items processed by one call to @p function.
+    ////////////////////////////////////////////////////////////////////////////
+    template <typename F>
+    result const& run(std::string name, size_t const items, F&& function) {
+        std::vector<double> times;
+        double total = 0.0;
+
+        while (total < min_time_ || times.size() < min_iterations_) {
+            auto const beg = clock::now();
+            function();
+            auto const end = clock::now();
+
+            auto const t = std::chrono::duration<double> {end - beg}.count();
+            times.push_back(t);
+            total += t;
+        }
+
+        return report_(std::move(name), items, times);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    //! Report times (in seconds) measured by the caller, e.g. one per seed.
+    ////////////////////////////////////////////////////////////////////////////
+    result const& record(std::string name, size_t const items, std::vector<double> times) {
+        return report_(std::move(name), items, times);
+    }
+
+    std::vector<result> const& results() const { return results_; }
+private:
+    result const& report_(std::string name, size_t items, std::vector<double>& times);
+
+    double              min_time_;
+    size_t              min_iterations_;
+    std::vector<result> results_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Prevent the optimizer from discarding @p value.
+////////////////////////////////////////////////////////////////////////////////
+void keep(void const* value);
+
+template <typename T>
+inline void keep(T const& value) {
+    keep(static_cast<void const*>(&value));
+}
+
+using bench_function = std::function<void (context&)>;
+
+////////////////////////////////////////////////////////////////////////////////
+//! Registers a benchmark at static initialization time.
+////////////////////////////////////////////////////////////////////////////////
+struct registrar {
+    registrar(char const* name, bench_function function);
+};
+
+} //namespace bench
+} //namespace yama
+
+#define BK_BENCH_CAT_IMPL(a, b) a##b
+#define BK_BENCH_CAT(a, b) BK_BENCH_CAT_IMPL(a, b)
+
+////////////////////////////////////////////////////////////////////////////////
+//! Define and register a benchmark; the body has a context& named ctx.
+////////////////////////////////////////////////////////////////////////////////
+#define BK_BENCHMARK(name) \
+static void BK_BENCH_CAT(bench_function_, __LINE__)(::yama::bench::context& ctx); \
+static ::yama::bench::registrar const BK_BENCH_CAT(bench_registrar_, __LINE__) { \
+    name, &BK_BENCH_CAT(bench_function_, __LINE__) \
+}; \
+static void BK_BENCH_CAT(bench_function_, __LINE__)(::yama::bench::context& ctx)
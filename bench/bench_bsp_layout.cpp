@@ -0,0 +1,168 @@
+#include "pch.hpp"
+#include "bench.hpp"
+
+#include "bsp_layout.hpp"
+#include "detail/bsp_layout_impl.hpp"
+
+#include <numeric>
+
+using namespace yama;
+using yama::bench::context;
+using yama::bench::keep;
+
+namespace {
+
+using phase_times_t = detail::bsp_layout_impl::phase_times_t;
+
+struct phase_info {
+    char const*                                 name;
+    phase_times_t::duration phase_times_t::*    member;
+};
+
+phase_info const phases[] = {
+    {"clear",       &phase_times_t::clear}
+  , {"tree",        &phase_times_t::tree}
+  , {"rooms",       &phase_times_t::rooms}
+  , {"write_rooms", &phase_times_t::write_rooms}
+  , {"connect",     &phase_times_t::connect}
+  , {"stairs",      &phase_times_t::stairs}
+};
+
+size_t const phase_count = sizeof(phases) / sizeof(phases[0]);
+
+double seconds(phase_times_t::duration const d) {
+    return std::chrono::duration<double> {d}.count();
+}
+
+} //namespace
+
+////////////////////////////////////////////////////////////////////////////////
+//! Whole levels and each phase of generate_into (reusing one map), one sample
+//! per seed. Run with --json to keep the results for comparison.
+////////////////////////////////////////////////////////////////////////////////
+BK_BENCHMARK("bsp_layout generation") {
+    int const seed_count = 500;
+
+    for (int const size : {64, 128, 256}) {
+        bsp_layout::params_t params;
+        params.map_w = size;
+        params.map_h = size;
+
+        detail::bsp_layout_impl layout {params};
+
+        phase_times_t times;
+        layout.set_phase_times(&times);
+
+        map reused {size, size};
+
+        std::vector<double> levels;
+        std::vector<double> new_levels;
+        std::vector<std::vector<double>> phase_samples (phase_count);
+
+        for (int seed = 0; seed < seed_count; ++seed) {
+            auto const beg = context::clock::now();
+            {
+                random_t random {static_cast<uint32_t>(seed)};
+                auto const m = layout.generate(random);
+                keep(m.width());
+            }
+            auto const mid = context::clock::now();
+            {
+                random_t random {static_cast<uint32_t>(seed)};
+                layout.generate_into(reused, random);
+                keep(reused.width());
+            }
+            auto const end = context::clock::now();
+
+            new_levels.push_back(std::chrono::duration<double> {mid - beg}.count());
+            levels.push_back(std::chrono::duration<double> {end - mid}.count());
+
+            for (size_t i = 0; i < phase_count; ++i) {
+                phase_samples[i].push_back(seconds(times.*phases[i].member));
+            }
+        }
+
+        auto const name = "bsp " + std::to_string(size);
+
+        ctx.record(name + " level (generate)", 1, new_levels);
+        auto const& level = ctx.record(name + " level (generate_into)", 1, levels);
+
+        auto const total = std::accumulate(levels.begin(), levels.end(), 0.0);
+        std::cout << name << ": " << static_cast<int>(seed_count / total) << " levels/s overall, "
+                  << static_cast<int>(1.0 / level.median) << " levels/s at p50" << std::endl;
+
+        for (size_t i = 0; i < phase_count; ++i) {
+            ctx.record(name + " phase " + phases[i].name, 1, phase_samples[i]);
+        }
+    }
+}
+
+BK_BENCHMARK("bsp_layout batch") {
+    bsp_layout::params_t params;
+    params.map_w = 128;
+    params.map_h = 128;
+
+    std::vector<uint32_t> seeds (64);
+    std::iota(seeds.begin(), seeds.end(), 1000u);
+
+    ctx.run("128 generate", 1, [&] {
+        random_t random {seeds[0]};
+        keep(bsp_layout {params}.generate(random).width());
+    });
+
+    for (int const threads : {1, 2, 4}) {
+        ctx.run("128 generate_batch x64 threads=" + std::to_string(threads), seeds.size(), [&] {
+            keep(generate_batch(seeds, params, threads).size());
+        });
+    }
+}
+
+BK_BENCHMARK("bsp_layout corridors") {
+    for (bool const route : {false, true}) {
+        bsp_layout::params_t params;
+        params.map_w = 256;
+        params.map_h = 256;
+        params.route_corridors = route;
+
+        bsp_layout layout {params};
+        map m {256, 256};
+
+        uint32_t seed = 0;
+        ctx.run(route ? "256 routed corridors" : "256 random walk corridors", 1, [&] {
+            random_t random {seed++ % 100};
+            layout.generate_into(m, random);
+            keep(m.width());
+        });
+    }
+}
+
+BK_BENCHMARK("bsp_layout subtrees") {
+    int const size = 2048;
+
+    bsp_layout::params_t params;
+    params.map_w = size;
+    params.map_h = size;
+
+    map m {size, size};
+
+    auto const items = static_cast<size_t>(size) * static_cast<size_t>(size);
+
+    ctx.run("2048 serial", items, [&] {
+        random_t random {1};
+        bsp_layout {params}.generate_into(m, random);
+        keep(m.width());
+    });
+
+    params.subtree_area = 256 * 256;
+
+    for (int const threads : {1, 2, 4}) {
+        bsp_layout layout {params};
+        layout.set_thread_count(threads);
+
+        ctx.run("2048 subtrees threads=" + std::to_string(threads), items, [&] {
+            random_t random {1};
+            layout.generate_into(m, random);
+            keep(m.width());
+        });
+    }
+}
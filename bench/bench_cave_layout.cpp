@@ -0,0 +1,36 @@
+#include "pch.hpp"
+#include "bench.hpp"
+
+#include "cave_layout.hpp"
+
+using namespace yama;
+using yama::bench::context;
+using yama::bench::keep;
+
+////////////////////////////////////////////////////////////////////////////////
+//! The random fill alone, then with the default five smoothing steps; the
+//! difference is the cost of smoothing.
+////////////////////////////////////////////////////////////////////////////////
+BK_BENCHMARK("cave_layout") {
+    for (int const size : {256, 1024}) {
+        auto const items = static_cast<size_t>(size) * static_cast<size_t>(size);
+        auto const name  = std::to_string(size);
+
+        map reused {size, size};
+
+        for (int const iterations : {0, 5}) {
+            cave_layout::params_t params;
+            params.map_w      = size;
+            params.map_h      = size;
+            params.iterations = iterations;
+
+            cave_layout layout {params};
+            random_t random {1002};
+
+            ctx.run(name + " cave iterations=" + std::to_string(iterations), items, [&] {
+                layout.generate_into(reused, random);
+                keep(reused.width());
+            });
+        }
+    }
+}
@@ -0,0 +1,69 @@
+#include "pch.hpp"
+#include "bench.hpp"
+
+#include "connectivity.hpp"
+#include "bsp_layout.hpp"
+
+using namespace yama;
+using yama::bench::context;
+using yama::bench::keep;
+
+namespace {
+
+bool is_passable(tile_category const c) {
+    return c == tile_category::floor
+        || c == tile_category::corridor
+        || c == tile_category::door;
+}
+
+} //namespace
+
+BK_BENCHMARK("connectivity") {
+    bsp_layout::params_t params;
+    params.map_w = 256;
+    params.map_h = 256;
+
+    random_t random {1002};
+    auto m = bsp_layout {params}.generate(random);
+
+    auto const items = static_cast<size_t>(m.width()) * static_cast<size_t>(m.height());
+
+    grid<component_label_t> labels {m.width(), m.height()};
+
+    ctx.run("256 map label_components", items, [&] {
+        keep(label_components(m, is_passable, labels, 1));
+    });
+
+    ctx.run("256 map label_rooms", items, [&] {
+        keep(label_rooms(m, is_passable, 1));
+    });
+
+    //the component of the first passable tile
+    grid_position_t start {0, 0};
+    for_each_xy(labels, [&](int const x, int const y, component_label_t const label) {
+        if (label == 1 && start.x == 0 && start.y == 0) {
+            start = grid_position_t {x, y};
+        }
+    });
+
+    ctx.run("256 map flood_fill one component", items, [&] {
+        keep(flood_fill(m, start.x, start.y, is_passable, room_id_t {1}));
+    });
+
+    //a noisy mask has far more components and unions than a level
+    int const size = 2048;
+
+    grid<uint8_t> mask {size, size};
+    for_each_xy(mask, [&](int, int, uint8_t& value) {
+        value = (random() % 100 < 55) ? 1 : 0;
+    });
+
+    grid<component_label_t> noise_labels {size, size};
+
+    for (int const threads : {1, 2, 4}) {
+        ctx.run("2048 noise label_components threads=" + std::to_string(threads)
+              , static_cast<size_t>(size) * static_cast<size_t>(size), [&] {
+            keep(label_components(mask, [](uint8_t const v) { return v != 0; }, noise_labels, threads));
+        });
+    }
+}
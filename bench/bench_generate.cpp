@@ -0,0 +1,66 @@
+#include "pch.hpp"
+#include "bench.hpp"
+
+#include "generate.hpp"
+
+#include <cmath>
+
+using namespace yama;
+using yama::bench::context;
+using yama::bench::keep;
+
+namespace {
+
+//! weighted_range before the alias tables, for comparison.
+int rejection_weighted_range(
+    random_t& random, closed_integral_interval<int> const range, int const weight, int const variance
+) {
+    auto const mean   = ((weight   / 100.0) + 1.0) / 2.0;
+    auto const stddev = ((variance / 100.0) + 1.0) / 2.0;
+    auto       dist   = std::normal_distribution<double> {mean, stddev};
+
+    auto const a     = static_cast<double>(range.lower);
+    auto const delta = static_cast<double>(range.upper) - a;
+
+    auto const lower_limit = -0.5 / delta;
+    auto const upper_limit = (delta + 0.5) / delta;
+
+    auto n = dist(random);
+    while (!(n > lower_limit && n < upper_limit)) {
+        n = dist(random);
+    }
+
+    return static_cast<int>(std::round(a + delta * n));
+}
+
+} //namespace
+
+BK_BENCHMARK("generate weighted_range") {
+    size_t const n = 1 << 14;
+
+    struct param_set { char const* name; int lower, upper, weight, variance; };
+
+    for (auto const p : {
+        param_set {"[4, 25] 0 0",       4, 25,    0,   0}
+      , param_set {"[0, 99] -100 -75",  0, 99, -100, -75}
+    }) {
+        auto const range = closed_integral_interval<> {p.lower, p.upper};
+        random_t random {1002};
+
+        ctx.run(std::string {p.name} + " rejection", n, [&] {
+            int sum = 0;
+            for (size_t i = 0; i < n; ++i) {
+                sum += rejection_weighted_range(random, range, p.weight, p.variance);
+            }
+            keep(sum);
+        });
+
+        ctx.run(std::string {p.name} + " alias table", n, [&] {
+            int sum = 0;
+            for (size_t i = 0; i < n; ++i) {
+                sum += generate::weighted_range(random, range, p.weight, p.variance);
+            }
+            keep(sum);
+        });
+    }
+}
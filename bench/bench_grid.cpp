@@ -0,0 +1,117 @@
+#include "pch.hpp"
+#include "bench.hpp"
+
+#include "grid.hpp"
+
+using namespace yama;
+using yama::bench::context;
+using yama::bench::keep;
+
+namespace {
+
+template <typename Grid>
+Grid make_grid(int const size) {
+    random_t random {1002};
+
+    Grid result {size, size};
+    for_each_xy(result, [&](int, int, uint16_t& value) {
+        value = static_cast<uint16_t>(random() & 1);
+    });
+
+    return result;
+}
+
+//! sum of every tile, visited in storage order.
+template <typename Grid>
+uint64_t sum_all(Grid const& g) {
+    uint64_t sum = 0;
+    for_each_xy(g, [&](int, int, uint16_t const value) {
+        sum += value;
+    });
+    return sum;
+}
+
+//! count the set tiles in the 3x3 neighborhood of every interior tile.
+template <typename Grid>
+uint64_t sum_neighbors(Grid const& g) {
+    auto const w = g.width();
+    auto const h = g.height();
+
+    uint64_t sum = 0;
+    for_each_xy(g, [&](int const x, int const y, uint16_t) {
+        if (x == 0 || y == 0 || x == w - 1 || y == h - 1) {
+            return;
+        }
+
+        sum += g(x - 1, y - 1) + g(x, y - 1) + g(x + 1, y - 1)
+             + g(x - 1, y    )               + g(x + 1, y    )
+             + g(x - 1, y + 1) + g(x, y + 1) + g(x + 1, y + 1);
+    });
+    return sum;
+}
+
+//! probe the 3x3 neighborhood along a random walk; roughly the access pattern
+//! of corridor tunneling and path finding.
+template <typename Grid>
+uint64_t sum_walk(Grid const& g, size_t const steps) {
+    random_t random {1002};
+
+    auto const w = g.width();
+    auto const h = g.height();
+
+    auto x = w / 2;
+    auto y = h / 2;
+
+    uint64_t sum = 0;
+    for (size_t i = 0; i < steps; ++i) {
+        auto const r = random();
+        x = clamp(x + static_cast<int>(r % 3) - 1,       1, w - 2);
+        y = clamp(y + static_cast<int>((r >> 8) % 3) - 1, 1, h - 2);
+
+        sum += g(x - 1, y - 1) + g(x, y - 1) + g(x + 1, y - 1)
+             + g(x - 1, y    )               + g(x + 1, y    )
+             + g(x - 1, y + 1) + g(x, y + 1) + g(x + 1, y + 1);
+    }
+    return sum;
+}
+
+template <typename Grid>
+void run_cases(context& ctx, char const* const layout, int const size) {
+    auto const g     = make_grid<Grid>(size);
+    auto const items = static_cast<size_t>(size) * static_cast<size_t>(size);
+    auto const name  = std::string {layout} + " " + std::to_string(size);
+
+    ctx.run(name + " for_each_xy", items, [&] {
+        keep(sum_all(g));
+    });
+
+    ctx.run(name + " 3x3 neighbors", items, [&] {
+        keep(sum_neighbors(g));
+    });
+
+    auto const steps = size_t {1} << 20;
+    ctx.run(name + " random walk", steps, [&] {
+        keep(sum_walk(g, steps));
+    });
+}
+
+template <typename Grid>
+void run_all(context& ctx, char const* const layout) {
+    for (auto const size : {64, 1024, 8192}) {
+        run_cases<Grid>(ctx, layout, size);
+    }
+}
+
+} //namespace
+
+BK_BENCHMARK("grid flat_layout") {
+    run_all<grid<uint16_t>>(ctx, "flat");
+}
+
+BK_BENCHMARK("grid chunked_layout<4>") {
+    run_all<chunked_grid<uint16_t, 4>>(ctx, "chunked 16x16");
+}
+
+BK_BENCHMARK("grid chunked_layout<5>") {
+    run_all<chunked_grid<uint16_t, 5>>(ctx, "chunked 32x32");
+}
@@ -0,0 +1,107 @@
+#include "pch.hpp"
+#include "bench.hpp"
+
+#include "grid.hpp"
+#include "grid_kernels.hpp"
+#include "tile.hpp"
+
+using namespace yama;
+using yama::bench::context;
+using yama::bench::keep;
+
+namespace {
+
+grid<tile_category> random_categories(int const size, uint32_t const seed) {
+    random_t random {seed};
+
+    grid<tile_category> result {size, size};
+    for_each_xy(result, [&](int, int, tile_category& value) {
+        value = static_cast<tile_category>(random() % 6);
+    });
+
+    return result;
+}
+
+} //namespace
+
+BK_BENCHMARK("grid kernels") {
+    std::cout << "isa: " << grid_kernels_isa() << std::endl;
+
+    for (auto const size : {256, 2048}) {
+        auto const a = random_categories(size, 1);
+        auto const b = random_categories(size, 2);
+
+        auto const items = static_cast<size_t>(size) * static_cast<size_t>(size);
+        auto const name  = std::to_string(size);
+
+        ctx.run(name + " count floor: for_each_xy", items, [&] {
+            size_t n = 0;
+            for_each_xy(a, [&](int, int, tile_category const value) {
+                n += (value == tile_category::floor) ? 1 : 0;
+            });
+            keep(n);
+        });
+
+        ctx.run(name + " count floor: count_if_equal", items, [&] {
+            keep(count_if_equal(a, tile_category::floor));
+        });
+
+        auto c = a;
+
+        ctx.run(name + " replace corridor: for_each_xy", items, [&] {
+            for_each_xy(c, [&](int, int, tile_category& value) {
+                value = (value == tile_category::corridor) ? tile_category::floor : value;
+            });
+            keep(c(0, 0));
+        });
+
+        ctx.run(name + " replace corridor: replace", items, [&] {
+            replace(c, tile_category::corridor, tile_category::floor);
+            keep(c(0, 0));
+        });
+
+        auto const same = a;
+
+        ctx.run(name + " equal: for_each_xy", items, [&] {
+            bool result = true;
+            for_each_xy(a, [&](int const x, int const y, tile_category const value) {
+                result &= (value == same(x, y));
+            });
+            keep(result);
+        });
+
+        ctx.run(name + " equal: equal", items, [&] {
+            keep(equal(a, same));
+        });
+
+        grid<uint8_t> mask {size, size};
+
+        ctx.run(name + " diff mask: for_each_xy", items, [&] {
+            size_t n = 0;
+            for_each_xy(a, [&](int const x, int const y, tile_category const value) {
+                auto const d = (value != b(x, y)) ? 1 : 0;
+                mask(x, y) = static_cast<uint8_t>(d);
+                n += d;
+            });
+            keep(n);
+        });
+
+        ctx.run(name + " diff mask: diff_mask", items, [&] {
+            keep(diff_mask(a, b, mask));
+        });
+
+        ctx.run(name + " histogram: for_each_xy", items, [&] {
+            size_t counts[6] = {};
+            for_each_xy(a, [&](int, int, tile_category const value) {
+                ++counts[static_cast<size_t>(value)];
+            });
+            keep(counts[2]);
+        });
+
+        ctx.run(name + " histogram: histogram", items, [&] {
+            size_t counts[6] = {};
+            histogram(a, counts, 6);
+            keep(counts[2]);
+        });
+    }
+}
@@ -0,0 +1,60 @@
+#include "pch.hpp"
+#include "bench.hpp"
+
+#include "layout_pipeline.hpp"
+
+using namespace yama;
+using yama::bench::context;
+using yama::bench::keep;
+
+////////////////////////////////////////////////////////////////////////////////
+//! Each stage of the default pipeline, one sample per seed; then the random
+//! walk and routed corridor stages against each other on the same memoized
+//! rooms, so that only corridors (and features) are re-run.
+////////////////////////////////////////////////////////////////////////////////
+BK_BENCHMARK("layout_pipeline") {
+    int const seed_count = 200;
+
+    bsp_layout::params_t params;
+    params.map_w = 256;
+    params.map_h = 256;
+
+    layout_pipeline pipeline {params};
+    map reused {params.map_w, params.map_h};
+
+    std::vector<std::vector<double>> samples (layout_pipeline::stage_count);
+
+    for (int seed = 0; seed < seed_count; ++seed) {
+        pipeline.generate_into(reused, static_cast<uint32_t>(seed));
+        keep(reused.width());
+
+        auto const& report = pipeline.last_report();
+        for (size_t i = 0; i < samples.size(); ++i) {
+            samples[i].push_back(std::chrono::duration<double> {report[i].time}.count());
+        }
+    }
+
+    for (size_t i = 0; i < samples.size(); ++i) {
+        auto const s = static_cast<layout_pipeline::stage>(i);
+        ctx.record(std::string {"256 stage "} + layout_pipeline::stage_name(s), 1, samples[i]);
+    }
+
+    for (bool const routed : {false, true}) {
+        pipeline.set_corridors_stage([routed](layout_pipeline::layout_t& layout, random_t& random
+                                            , layout_pipeline::rooms_t const& in, map& out) {
+            auto p = layout.params();
+            p.route_corridors = routed;
+            layout.set_params(p);
+
+            layout_pipeline::default_corridors()(layout, random, in, out);
+        });
+
+        pipeline.generate_into(reused, 1);
+
+        ctx.run(std::string {"256 corridors only, "} + (routed ? "routed" : "random walk"), 1, [&] {
+            pipeline.invalidate(layout_pipeline::stage::corridors);
+            pipeline.generate_into(reused, 1);
+            keep(reused.width());
+        });
+    }
+}
@@ -0,0 +1,48 @@
+#include "pch.hpp"
+#include "bench.hpp"
+
+#include "level_cache.hpp"
+
+#include <cstdio>
+
+using namespace yama;
+using yama::bench::context;
+using yama::bench::keep;
+
+BK_BENCHMARK("level_cache") {
+    bsp_layout::params_t params;
+    params.map_w = 256;
+    params.map_h = 256;
+
+    level_cache cache {".", uint64_t {1} << 30};
+
+    ctx.run("256 generate", 1, [&] {
+        random_t random {1};
+        keep(bsp_layout {params}.generate(random).width());
+    });
+
+    //warm the cache
+    cache.get(1, params);
+
+    ctx.run("256 warm get", 1, [&] {
+        keep(cache.get(1, params).level_map.width());
+    });
+
+    //a hit reads only the tiles it touches; this reads all of them
+    ctx.run("256 warm get + read every tile", 1, [&] {
+        auto const level = cache.get(1, params);
+        auto const v = level.level_map.view<map_property::category>();
+
+        int count = 0;
+        for (int y = 0; y < v.height(); ++y) {
+            for (int x = 0; x < v.width(); ++x) {
+                count += (v(x, y) == tile_category::floor) ? 1 : 0;
+            }
+        }
+        keep(count);
+    });
+
+    std::remove(cache.file_name(level_key(1, params)).c_str());
+    std::remove("./level_cache.index");
+    std::remove("./level_cache.lock");
+}
@@ -0,0 +1,146 @@
+#include "pch.hpp"
+#include "bench.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+
+using namespace yama::bench;
+
+namespace {
+
+struct entry {
+    char const*    name;
+    bench_function function;
+};
+
+void const* volatile keep_sink = nullptr;
+
+std::vector<entry>& get_registry() {
+    static std::vector<entry> registry;
+    return registry;
+}
+
+void print_result(result const& r) {
+    auto const per_item = r.items ? r.median / static_cast<double>(r.items) : 0.0;
+    auto const rate     = r.median > 0.0 ? static_cast<double>(r.items) / r.median : 0.0;
+
+    std::cout << std::left  << std::setw(48) << r.name
+              << std::right << std::setw(14) << std::fixed << std::setprecision(3)
+              << r.median * 1.0e3 << " ms"
+              << std::setw(12) << std::setprecision(3) << per_item * 1.0e9 << " ns/item"
+              << std::setw(14) << std::setprecision(1) << rate / 1.0e6 << " M items/s"
+              << std::setw(14) << std::setprecision(3) << r.p99 * 1.0e3 << " ms p99"
+              << std::endl;
+}
+
+//! write @p s as a JSON string; names are plain ascii.
+void write_json_string(std::ostream& out, std::string const& s) {
+    out << '"';
+    for (auto const c : s) {
+        if (c == '"' || c == '\\') {
+            out << '\\';
+        }
+        out << c;
+    }
+    out << '"';
+}
+
+void write_json(std::ostream& out, std::vector<result> const& results) {
+    out << std::setprecision(9) << "[\n";
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        auto const& r = results[i];
+
+        out << "  {\"name\": ";
+        write_json_string(out, r.name);
+        out << ", \"iterations\": " << r.iterations
+            << ", \"items\": "      << r.items
+            << ", \"best\": "       << r.best
+            << ", \"median\": "     << r.median
+            << ", \"p99\": "        << r.p99
+            << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+
+    out << "]\n";
+}
+
+} //namespace
+
+//==============================================================================
+context::context(double const min_time, size_t const min_iterations)
+  : min_time_ {min_time}
+  , min_iterations_ {min_iterations}
+  , results_ {}
+{
+}
+//------------------------------------------------------------------------------
+result const& context::report_(
+    std::string          name
+  , size_t const         items
+  , std::vector<double>& times
+) {
+    std::sort(std::begin(times), std::end(times));
+
+    BK_ASSERT(!times.empty());
+
+    //nearest rank
+    auto const p99 = times[(times.size() * 99 + 99) / 100 - 1];
+
+    results_.push_back(result {
+        std::move(name), times.size(), items, times.front(), times[times.size() / 2], p99
+    });
+
+    print_result(results_.back());
+
+    return results_.back();
+}
+//==============================================================================
+void yama::bench::keep(void const* value) {
+    keep_sink = value;
+}
+//==============================================================================
+registrar::registrar(char const* const name, bench_function function) {
+    get_registry().push_back(entry {name, std::move(function)});
+}
+//==============================================================================
+//! Entry point: bench [filter] [--json file]
+//!
+//! Runs every benchmark whose name contains filter (if given) and optionally
+//! writes all results to file as JSON.
+//==============================================================================
+int SDL_main(int argc, char* argv[]) {
+    char const* filter    = "";
+    char const* json_file = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        if (!std::strcmp(argv[i], "--json") && i + 1 < argc) {
+            json_file = argv[++i];
+        } else {
+            filter = argv[i];
+        }
+    }
+
+    context ctx;
+
+    for (auto const& e : get_registry()) {
+        if (!std::strstr(e.name, filter)) {
+            continue;
+        }
+
+        std::cout << "[" << e.name << "]" << std::endl;
+        e.function(ctx);
+    }
+
+    if (json_file) {
+        std::ofstream out {json_file};
+        write_json(out, ctx.results());
+
+        if (!out) {
+            std::cerr << "failed to write " << json_file << std::endl;
+            return 1;
+        }
+    }
+
+    return 0;
+}
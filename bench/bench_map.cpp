@@ -0,0 +1,76 @@
+#include "pch.hpp"
+#include "bench.hpp"
+
+#include "map.hpp"
+
+using namespace yama;
+using yama::bench::context;
+using yama::bench::keep;
+
+BK_BENCHMARK("map category reads") {
+    constexpr int size = 1024;
+
+    random_t random {1002};
+
+    map m {size, size};
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            m.set<map_property::category>(x, y, static_cast<tile_category>(random() % 6));
+        }
+    }
+
+    auto const items = static_cast<size_t>(size) * static_cast<size_t>(size);
+
+    ctx.run("map::get", items, [&] {
+        size_t n = 0;
+        for (int y = 0; y < size; ++y) {
+            for (int x = 0; x < size; ++x) {
+                n += (m.get<map_property::category>(x, y) == tile_category::floor) ? 1 : 0;
+            }
+        }
+        keep(n);
+    });
+
+    ctx.run("map::view", items, [&] {
+        auto const v = m.view<map_property::category>();
+
+        size_t n = 0;
+        for (int y = 0; y < size; ++y) {
+            for (int x = 0; x < size; ++x) {
+                n += (v(x, y) == tile_category::floor) ? 1 : 0;
+            }
+        }
+        keep(n);
+    });
+
+    ctx.run("map::read_rect", items, [&] {
+        std::vector<tile_category> buffer (items);
+        m.read_rect<map_property::category>(rect_t {0, 0, size, size}, buffer.data());
+
+        size_t n = 0;
+        for (auto const value : buffer) {
+            n += (value == tile_category::floor) ? 1 : 0;
+        }
+        keep(n);
+    });
+}
+
+BK_BENCHMARK("map category writes") {
+    constexpr int size = 1024;
+
+    map m {size, size};
+
+    auto const items = static_cast<size_t>(size) * static_cast<size_t>(size);
+
+    ctx.run("map::set", items, [&] {
+        for (int y = 0; y < size; ++y) {
+            for (int x = 0; x < size; ++x) {
+                m.set<map_property::category>(x, y, tile_category::floor);
+            }
+        }
+    });
+
+    ctx.run("map::fill_rect", items, [&] {
+        m.fill_rect<map_property::category>(rect_t {0, 0, size, size}, tile_category::floor);
+    });
+}
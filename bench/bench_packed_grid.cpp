@@ -0,0 +1,69 @@
+#include "pch.hpp"
+#include "bench.hpp"
+
+#include "grid.hpp"
+#include "packed_grid.hpp"
+#include "tile.hpp"
+
+using namespace yama;
+using yama::bench::context;
+using yama::bench::keep;
+
+namespace {
+
+tile_category random_category(random_t& random) {
+    return static_cast<tile_category>(random() % 6);
+}
+
+} //namespace
+
+BK_BENCHMARK("packed_grid category scan") {
+    for (auto const size : {256, 4096}) {
+        random_t random {1002};
+
+        grid<tile_category>           flat   {size, size};
+        packed_grid<tile_category, 4> packed {size, size};
+
+        for (int y = 0; y < size; ++y) {
+            for (int x = 0; x < size; ++x) {
+                auto const value = random_category(random);
+                flat(x, y) = value;
+                packed.set(x, y, value);
+            }
+        }
+
+        auto const items = static_cast<size_t>(size) * static_cast<size_t>(size);
+        auto const name  = std::to_string(size);
+
+        ctx.run(name + " grid<tile_category> count floor", items, [&] {
+            size_t n = 0;
+            for_each_xy(flat, [&](int, int, tile_category const value) {
+                n += (value == tile_category::floor) ? 1 : 0;
+            });
+            keep(n);
+        });
+
+        ctx.run(name + " packed per-tile count floor", items, [&] {
+            size_t n = 0;
+            for (int y = 0; y < size; ++y) {
+                for (int x = 0; x < size; ++x) {
+                    n += (packed(x, y) == tile_category::floor) ? 1 : 0;
+                }
+            }
+            keep(n);
+        });
+
+        ctx.run(name + " packed decode_row count floor", items, [&] {
+            std::vector<tile_category> row (static_cast<size_t>(size));
+
+            size_t n = 0;
+            for (int y = 0; y < size; ++y) {
+                packed.decode_row(y, row.data());
+                for (auto const value : row) {
+                    n += (value == tile_category::floor) ? 1 : 0;
+                }
+            }
+            keep(n);
+        });
+    }
+}
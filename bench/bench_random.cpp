@@ -0,0 +1,115 @@
+#include "pch.hpp"
+#include "bench.hpp"
+
+#include "random.hpp"
+#include "bsp_layout.hpp"
+
+#include <iostream>
+#include <type_traits>
+#include <vector>
+
+using namespace yama;
+using yama::bench::context;
+using yama::bench::keep;
+
+namespace {
+
+template <typename Engine>
+void run_engine(context& ctx, std::string const& name) {
+    size_t const n = 1 << 16;
+
+    std::cout << name << ": " << sizeof(Engine) << " bytes of state" << std::endl;
+
+    Engine random {1002};
+
+    ctx.run(name + " raw", n, [&] {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < n; ++i) {
+            sum += random();
+        }
+        keep(sum);
+    });
+
+    ctx.run(name + " random_uniform [1, 6]", n, [&] {
+        int sum = 0;
+        for (size_t i = 0; i < n; ++i) {
+            sum += random_uniform(random, 1, 6);
+        }
+        keep(sum);
+    });
+
+    ctx.run(name + " std::uniform_int_distribution [1, 6]", n, [&] {
+        int sum = 0;
+        for (size_t i = 0; i < n; ++i) {
+            sum += std::uniform_int_distribution<> {1, 6}(random);
+        }
+        keep(sum);
+    });
+
+    std::vector<int> batch (n);
+    ctx.run(name + " random_uniform_n [1, 6]", n, [&] {
+        random_uniform_n(random, 1, 6, batch.data(), batch.size());
+        keep(batch.back());
+    });
+
+    ctx.run(name + " random_percent", n, [&] {
+        int sum = 0;
+        for (size_t i = 0; i < n; ++i) {
+            sum += random_percent(random);
+        }
+        keep(sum);
+    });
+
+    ctx.run(name + " seed", 1024, [&] {
+        for (uint32_t i = 0; i < 1024; ++i) {
+            Engine e {i};
+            keep(e());
+        }
+    });
+}
+
+char const* random_t_name() {
+    return std::is_same<random_t, xoshiro256ss>::value ? "xoshiro256**"
+         : std::is_same<random_t, pcg64>::value        ? "pcg64"
+         : "mt19937";
+}
+
+} //namespace
+
+////////////////////////////////////////////////////////////////////////////////
+//! The engines side by side; whole levels only with random_t, so build with
+//! YAMA_RANDOM_XOSHIRO256 or YAMA_RANDOM_PCG64 defined to compare those.
+////////////////////////////////////////////////////////////////////////////////
+BK_BENCHMARK("random engines") {
+    run_engine<std::mt19937>(ctx, "mt19937");
+    run_engine<xoshiro256ss>(ctx, "xoshiro256**");
+    run_engine<pcg64>(ctx, "pcg64");
+
+    std::vector<uint32_t> row (1024);
+
+    ctx.run("hash_random 1024 tiles", row.size(), [&] {
+        for (size_t i = 0; i < row.size(); ++i) {
+            row[i] = hash_random(1002, static_cast<int>(i), 7, 0);
+        }
+        keep(row.back());
+    });
+
+    ctx.run("hash_random_row 1024 tiles", row.size(), [&] {
+        hash_random_row(1002, 0, 7, 0, row.data(), row.size());
+        keep(row.back());
+    });
+
+    bsp_layout::params_t params;
+    params.map_w = 128;
+    params.map_h = 128;
+
+    bsp_layout layout {params};
+    map reused {params.map_w, params.map_h};
+
+    uint32_t seed = 0;
+    ctx.run(std::string {"bsp 128 level, random_t = "} + random_t_name(), 1, [&] {
+        random_t random {seed++};
+        layout.generate_into(reused, random);
+        keep(reused.width());
+    });
+}
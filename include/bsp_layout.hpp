@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
+#include <vector>
 
 #include "types.hpp"
 #include "math.hpp"
@@ -15,6 +17,10 @@ namespace yama {
 ////////////////////////////////////////////////////////////////////////////////
 class bsp_layout {
 public:
+    //! Changed whenever the same seed and params_t generate a different level;
+    //! part of every level_cache key.
+    static constexpr uint32_t generator_version = 4;
+
     ////////////////////////////////////////////////////////////////////////////
     //! BSP layout generation parameters.
     ////////////////////////////////////////////////////////////////////////////
@@ -49,6 +55,17 @@ public:
         aspect_ratio<float> split_limit_aspect {16.0f / 10.0f};
 
         positive<float> corridor_randomness {0.25f};
+
+        //! Route corridors with a least-cost search over the parent region,
+        //! using corridor_randomness as cost noise, instead of random walks.
+        //! A random walk is still used where no route exists.
+        bool route_corridors {false};
+
+        //! Generate subtrees of at most this many tiles independently, each
+        //! from its own random stream, on worker threads; 0 generates the whole
+        //! tree at once. Levels differ from those made with 0, but not between
+        //! thread counts.
+        positive<int> subtree_area {0};
     };
 
     explicit bsp_layout(params_t p = params_t {});
@@ -57,12 +74,41 @@ public:
     params_t params() const;
     void set_params(params_t p = params_t {});
 
+    //! The maximum number of threads used for subtrees; 0 (the default) for
+    //! one per core. See params_t::subtree_area.
+    void set_thread_count(int n);
+
     map generate(random_t& random);
 
+    ////////////////////////////////////////////////////////////////////////////
+    //! Generate into @p out; the same as out = generate(random), but a map of
+    //! the right size is reused, so regenerating allocates nothing once the
+    //! internal buffers have grown.
+    ////////////////////////////////////////////////////////////////////////////
+    void generate_into(map& out, random_t& random);
+
     std::vector<rect_t> get_regions() const;
+
+    //! The rooms of the last generated level, in generation order; the stairs
+    //! are in the first and last.
+    std::vector<rect_t> const& get_rooms() const;
 private:
     class impl_t;
     std::unique_ptr<impl_t> impl_;
 };
 
+////////////////////////////////////////////////////////////////////////////////
+//! Generate one map per seed with @p params, using up to @p thread_count
+//! threads (0 for one per core).
+//!
+//! Each map is generated from its own random_t seeded with its seed, so the
+//! results are in seed order and identical for any thread count; the map for
+//! seed s equals bsp_layout {params}.generate(random_t {s}).
+////////////////////////////////////////////////////////////////////////////////
+std::vector<map> generate_batch(
+    std::vector<uint32_t> const& seeds
+  , bsp_layout::params_t  const& params
+  , int                          thread_count = 0
+);
+
 } //namespace yama
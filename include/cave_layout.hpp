@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "types.hpp"
+#include "math.hpp"
+#include "map.hpp"
+
+namespace yama {
+
+////////////////////////////////////////////////////////////////////////////////
+//! Cellular automaton cave generator.
+//!
+//! Tiles start as walls at random, then the 4-5 rule is applied a number of
+//! times: a tile becomes a wall if at least 5 tiles of the 3x3 block around it
+//! are walls, and floor otherwise. Tiles off the map count as walls and the
+//! outermost tiles are always walls.
+//!
+//! The start of each tile is hash_random of its position (offset by the
+//! origin) and a seed drawn from the random_t. So a region of a larger map,
+//! generated on its own with its offset as the origin, comes out the same
+//! but for a margin of iterations + 1 tiles, where its forced edge reaches.
+//!
+//! The grid is kept as one bit per tile, so each step updates 64 tiles per
+//! machine word.
+//!
+//! pimpl based
+////////////////////////////////////////////////////////////////////////////////
+class cave_layout {
+public:
+    ////////////////////////////////////////////////////////////////////////////
+    //! Cave layout generation parameters.
+    ////////////////////////////////////////////////////////////////////////////
+    struct params_t {
+        params_t() {}
+
+        map_size map_w {64}; //!< Generated map width.
+        map_size map_h {64}; //!< Generated map height.
+
+        strict_percentage<int> wall_chance {45}; //!< The chance of each tile starting as a wall.
+
+        positive<int> iterations {5}; //!< The number of smoothing steps.
+
+        int x0 {0}; //!< The position of the map's left column in the start.
+        int y0 {0}; //!< The position of the map's top row in the start.
+    };
+
+    explicit cave_layout(params_t p = params_t {});
+    ~cave_layout();
+
+    params_t params() const;
+    void set_params(params_t p = params_t {});
+
+    map generate(random_t& random);
+
+    //! Generate into @p out; a map of the right size is reused.
+    void generate_into(map& out, random_t& random);
+private:
+    class impl_t;
+    std::unique_ptr<impl_t> impl_;
+};
+
+} //namespace yama
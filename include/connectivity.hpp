@@ -0,0 +1,231 @@
+////////////////////////////////////////////////////////////////////////////////
+//! @file
+//! Connected component labeling and flood fill for grids and maps.
+//!
+//! Tiles are connected to their 4 orthogonal neighbors.
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "assert.hpp"
+#include "types.hpp"
+#include "grid.hpp"
+#include "map.hpp"
+
+namespace yama {
+
+//! 0 for impassable tiles, otherwise 1 + the index of the tile's component.
+using component_label_t = uint32_t;
+
+namespace detail {
+
+////////////////////////////////////////////////////////////////////////////////
+//! Label the components of the non-zero tiles of @p mask into @p labels.
+//!
+//! The grid is split into bands of rows labeled in parallel with a union-find
+//! forest over tile indices; the bands are then merged along their boundaries
+//! and labels made sequential, in raster order of each component's first tile.
+//!
+//! @param thread_count The maximum number of threads; 0 for one per core.
+//! @returns the number of components.
+////////////////////////////////////////////////////////////////////////////////
+int label_mask(grid<uint8_t> const& mask, grid<component_label_t>& labels, int thread_count);
+
+} //namespace detail
+
+////////////////////////////////////////////////////////////////////////////////
+//! Label the components of tiles of @p g for which passable(value) is true.
+//!
+//! @returns the number of components; labels are in [1, count].
+////////////////////////////////////////////////////////////////////////////////
+template <typename T, typename Predicate>
+int label_components(
+    grid<T>                  const& g
+  , Predicate                    && passable
+  , grid<component_label_t>&        labels
+  , int                       const thread_count = 0
+) {
+    BK_ASSERT(labels.width() == g.width() && labels.height() == g.height());
+
+    grid<uint8_t> mask {g.width(), g.height()};
+    for (int y = 0; y < g.height(); ++y) {
+        auto const in  = g.row(y);
+        auto const out = mask.row(y);
+        for (int x = 0; x < g.width(); ++x) {
+            out[x] = passable(in[x]) ? 1 : 0;
+        }
+    }
+
+    return detail::label_mask(mask, labels, thread_count);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Label the components of tiles of @p m whose category satisfies passable.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Predicate>
+int label_components(
+    map                      const& m
+  , Predicate                    && passable
+  , grid<component_label_t>&        labels
+  , int                       const thread_count = 0
+) {
+    BK_ASSERT(labels.width() == m.width() && labels.height() == m.height());
+
+    //categories are 4 bits; evaluate passable once per value
+    using view_t = map::view_t<map_property::category>;
+
+    uint8_t table[view_t::value_mask + 1];
+    for (size_t v = 0; v <= view_t::value_mask; ++v) {
+        table[v] = passable(static_cast<tile_category>(v)) ? 1 : 0;
+    }
+
+    grid<uint8_t> mask {m.width(), m.height()};
+    std::vector<tile_category> row (static_cast<size_t>(m.width()));
+
+    for (int y = 0; y < m.height(); ++y) {
+        m.read_row<map_property::category>(y, row.data());
+
+        auto const out = mask.row(y);
+        for (int x = 0; x < m.width(); ++x) {
+            out[x] = table[static_cast<size_t>(row[x])];
+        }
+    }
+
+    return detail::label_mask(mask, labels, thread_count);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Set the room_id of every tile of @p m to the label of its component of
+//! passable tiles; 0 for impassable tiles.
+//!
+//! @returns the number of components.
+//! @pre there are fewer components than room_id_t can represent.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Predicate>
+int label_rooms(map& m, Predicate&& passable, int const thread_count = 0) {
+    grid<component_label_t> labels {m.width(), m.height()};
+    auto const count = label_components(m, passable, labels, thread_count);
+
+    BK_ASSERT(count <= std::numeric_limits<room_id_t>::max());
+
+    std::vector<room_id_t> row (static_cast<size_t>(m.width()));
+    for (int y = 0; y < m.height(); ++y) {
+        auto const in = labels.row(y);
+        std::transform(in, in + m.width(), row.begin()
+          , [](component_label_t const l) { return static_cast<room_id_t>(l); });
+
+        m.write_rect<map_property::room_id>(rect_t {0, y, m.width(), y + 1}, row.data());
+    }
+
+    return count;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Scanline flood fill from (x, y) over the width x height area.
+//!
+//! Calls passable(x, y) to test tiles and fill(y, x0, x1) once for each
+//! horizontal span [x0, x1) reached; every tile is reported at most once, so
+//! fill may make tiles impassable or not.
+//!
+//! @returns the number of tiles filled.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Passable, typename Fill>
+size_t scanline_fill(int const width, int const height, int const x, int const y
+                   , Passable&& passable, Fill&& fill
+) {
+    BK_ASSERT(x >= 0 && x < width && y >= 0 && y < height);
+
+    std::vector<bool> visited (static_cast<size_t>(width) * static_cast<size_t>(height));
+
+    auto const is_open = [&](int const xi, int const yi) {
+        return !visited[static_cast<size_t>(xi) + static_cast<size_t>(yi) * static_cast<size_t>(width)]
+            && passable(xi, yi);
+    };
+
+    std::vector<grid_position_t> seeds;
+    seeds.push_back(grid_position_t {x, y});
+
+    //push the start of each open run in [x0, x1) of row yi.
+    auto const push_runs = [&](int const yi, int const x0, int const x1) {
+        if (yi < 0 || yi >= height) {
+            return;
+        }
+
+        for (auto xi = x0; xi < x1; ++xi) {
+            if (!is_open(xi, yi)) {
+                continue;
+            }
+
+            seeds.push_back(grid_position_t {xi, yi});
+            while (xi < x1 && is_open(xi, yi)) {
+                ++xi;
+            }
+        }
+    };
+
+    size_t result = 0;
+
+    while (!seeds.empty()) {
+        auto const p = seeds.back();
+        seeds.pop_back();
+
+        if (!is_open(p.x, p.y)) {
+            continue;
+        }
+
+        auto x0 = p.x;
+        auto x1 = p.x + 1;
+
+        while (x0 > 0 && is_open(x0 - 1, p.y)) {
+            --x0;
+        }
+
+        while (x1 < width && is_open(x1, p.y)) {
+            ++x1;
+        }
+
+        auto const row = static_cast<size_t>(p.y) * static_cast<size_t>(width);
+        std::fill(visited.begin() + static_cast<ptrdiff_t>(row + x0)
+                , visited.begin() + static_cast<ptrdiff_t>(row + x1), true);
+
+        fill(p.y, x0, x1);
+        result += static_cast<size_t>(x1 - x0);
+
+        push_runs(p.y - 1, x0, x1);
+        push_runs(p.y + 1, x0, x1);
+    }
+
+    return result;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Set every tile of @p g connected to (x, y) for which passable(value) is
+//! true to @p value; returns the number of tiles set.
+////////////////////////////////////////////////////////////////////////////////
+template <typename T, typename Predicate>
+size_t flood_fill(grid<T>& g, int const x, int const y, Predicate&& passable, T const value) {
+    return scanline_fill(g.width(), g.height(), x, y
+      , [&](int const xi, int const yi) { return passable(g(xi, yi)); }
+      , [&](int const yi, int const x0, int const x1) { std::fill(g.row(yi) + x0, g.row(yi) + x1, value); });
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Set the room_id of every tile of @p m connected to (x, y) whose category
+//! satisfies passable to @p room; returns the number of tiles set.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Predicate>
+size_t flood_fill(map& m, int const x, int const y, Predicate&& passable, room_id_t const room) {
+    auto const categories = m.view<map_property::category>();
+
+    return scanline_fill(m.width(), m.height(), x, y
+      , [&](int const xi, int const yi) { return passable(categories(xi, yi)); }
+      , [&](int const yi, int const x0, int const x1) {
+            m.fill_rect<map_property::room_id>(rect_t {x0, yi, x1, yi + 1}, room);
+        });
+}
+
+} //namespace yama
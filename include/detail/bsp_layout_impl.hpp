@@ -1,5 +1,6 @@
 #pragma once
 
+#include <chrono>
 #include <vector>
 
 #include "bsp_layout.hpp"
@@ -51,6 +52,21 @@ public:
         rect_t  bounds;
     };
 
+    ////////////////////////////////////////////////////////////////////////////
+    //! The time spent in each phase of generate.
+    ////////////////////////////////////////////////////////////////////////////
+    struct phase_times_t {
+        using clock    = std::chrono::high_resolution_clock;
+        using duration = clock::duration;
+
+        duration clear       {}; //!< clearing (or allocating) the map and state.
+        duration tree        {}; //!< generate_tree.
+        duration rooms       {}; //!< generate_rooms.
+        duration write_rooms {}; //!< write_room for every room.
+        duration connect     {}; //!< connect from the root.
+        duration stairs      {}; //!< stair placement.
+    };
+
     static params_t validate(params_t params);
 public:
     //! construct with a (default) param set.
@@ -66,12 +82,25 @@ public:
         params_ = validate(p);
     }
 
+    //! time the phases of each generate call into @p times; nullptr to stop.
+    void set_phase_times(phase_times_t* const times) {
+        phase_times_ = times;
+    }
+
+    //! set the maximum number of threads for subtrees; 0 for one per core.
+    void set_thread_count(int const n) {
+        thread_count_ = n;
+    }
+
     //! reset internal state and keep the current param set.
     void clear();
 
     //! generate a new map
     map generate(random_t& random);
 
+    //! generate into @p out, reusing its storage if it is the right size.
+    void generate_into(map& out, random_t& random);
+
     //! decide whether to split a node.
     bool do_split(random_t& random, rect_t bounds) const;
 
@@ -93,11 +122,38 @@ public:
     //! create the bsp tree
     void generate_tree(random_t& random);
 
+    //! put a stair in the first and in the last room; none without rooms.
+    //! @returns the number of stairs placed; their positions are written to
+    //! @p out unless it is nullptr.
+    int place_stairs(random_t& random, grid_position_t* out);
+
+    ////////////////////////////////////////////////////////////////////////////
+    //! Split nodes larger than params_t::subtree_area, then generate each leaf
+    //! as an independent subtree on worker threads, then write them to the map;
+    //! each leaf's data is then the room its subtree was connected through.
+    ////////////////////////////////////////////////////////////////////////////
+    void generate_subtrees(random_t& random);
+
+    //! write the tiles of every subtree to the map; on the calling thread.
+    void write_subtrees();
+
+    //! replace the leaves of the top tree by the nodes of their subtrees; once
+    //! the top tree has been connected.
+    void splice_subtrees();
+
     ////////////////////////////////////////////////////////////////////////////
     //! Connect two rects contained within bounds.
     ////////////////////////////////////////////////////////////////////////////
     void do_connect(random_t& random, rect_t bounds, rect_t first, rect_t second);
 
+    ////////////////////////////////////////////////////////////////////////////
+    //! Connect @p first to @p second with the cheapest corridor within
+    //! @p bounds; see params_t::route_corridors.
+    //!
+    //! @returns false if no corridor obeying can_tunnel exists.
+    ////////////////////////////////////////////////////////////////////////////
+    bool route_corridor(random_t& random, rect_t bounds, rect_t first, rect_t second);
+
     ////////////////////////////////////////////////////////////////////////////
     //! 3-state logic of sorts.
     ////////////////////////////////////////////////////////////////////////////
@@ -151,10 +207,58 @@ public:
         return result;
     }
 
+    std::vector<rect_t> const& get_rooms() const {
+        return rooms_;
+    }
+
     params_t            params_;
     std::vector<node>   nodes_;
     std::vector<rect_t> rooms_;
-    yama::map           map_;
+    //! Scratch for write_room.
+    struct room_scratch_t {
+        std::vector<uint8_t>       ring;  //!< wall or door flags of the surrounding tiles.
+        std::vector<tile_category> strip; //!< a row of the surrounding tiles.
+        std::vector<tile_category> tiles; //!< the room, row-major.
+    };
+
+    ////////////////////////////////////////////////////////////////////////////
+    //! Scratch for route_corridor, one entry per tile of the bounds searched;
+    //! grown only for larger bounds. Entries stamped with an older search are
+    //! unreached, so nothing is cleared per search.
+    ////////////////////////////////////////////////////////////////////////////
+    struct route_scratch_t {
+        struct tile_t {
+            uint32_t search; //!< the search that last reached this tile.
+            uint32_t closed; //!< the search that last expanded this tile.
+            uint32_t cost;   //!< the cheapest known cost to this tile.
+            uint32_t from;   //!< the step this tile was reached by.
+        };
+
+        std::vector<tile_t> tiles;
+        uint32_t            search = 0;
+        std::vector<std::pair<uint32_t, uint32_t>> open; //!< {estimate, tile} min heap.
+    };
+
+    ////////////////////////////////////////////////////////////////////////////
+    //! A leaf of the top tree generated independently; in map coordinates.
+    ////////////////////////////////////////////////////////////////////////////
+    struct subtree_t {
+        node::index_t              leaf;        //!< the leaf of the top tree.
+        uint32_t                   seed;        //!< the seed of its random stream.
+        std::vector<node>          nodes;       //!< nodes[0] is the root.
+        std::vector<rect_t>        rooms;
+        size_t                     room_offset; //!< where rooms start in rooms_.
+        std::pair<bool, rect_t>    connected;   //!< connect's result for the root.
+        std::vector<tile_category> tiles;       //!< row-major; until written.
+    };
+
+    std::vector<node*>     room_nodes_;        //!< scratch for generate_rooms.
+    room_scratch_t         room_scratch_;
+    route_scratch_t        route_;
+    std::vector<subtree_t> subtrees_;
+    int                    thread_count_ = 0;  //!< for subtrees; 0 for one per core.
+    yama::map*             map_ = nullptr;     //!< the map being generated.
+    phase_times_t*         phase_times_ = nullptr;
 };
 
 } //namespace detail
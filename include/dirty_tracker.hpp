@@ -0,0 +1,87 @@
+////////////////////////////////////////////////////////////////////////////////
+//! @file
+//! Chunk granularity tracking of changed map regions.
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "assert.hpp"
+#include "types.hpp"
+
+namespace yama {
+
+////////////////////////////////////////////////////////////////////////////////
+//! Tracks which chunks of a width x height area were changed, per epoch.
+//!
+//! Every change sets one bit in the bitset of the current epoch. The owner
+//! advances the epoch (e.g. once per frame) with next_epoch; each consumer
+//! remembers the last epoch it saw and asks for changed_since(that epoch).
+//! The bitsets of the last history epochs are kept; asking for anything older
+//! reports the whole area as changed. Each row of chunks starts on a new word,
+//! so changes to different rows of chunks can be marked concurrently.
+////////////////////////////////////////////////////////////////////////////////
+class dirty_tracker {
+public:
+    using epoch_t = uint64_t;
+
+    static int const chunk_bits = 4;
+    static int const chunk_size = 1 << chunk_bits; //!< Chunk width and height.
+    static int const history    = 32;              //!< Epochs kept.
+
+    //! everything starts dirty in epoch 0.
+    dirty_tracker(int width, int height);
+
+    //! mark the chunk containing (x, y).
+    void mark(int const x, int const y) {
+        BK_ASSERT(x >= 0 && x < width_ && y >= 0 && y < height_);
+
+        auto const c = bit_(x >> chunk_bits, y >> chunk_bits);
+
+        bits_[current_ + (c >> 6)] |= uint64_t {1} << (c & 63);
+    }
+
+    //! mark every chunk overlapping @p r.
+    void mark(rect_t r);
+
+    //! mark every chunk.
+    void mark_all();
+
+    //! the current epoch; changes made now belong to it.
+    epoch_t epoch() const { return epoch_; }
+
+    //! end the current epoch; returns the new, current, epoch.
+    epoch_t next_epoch();
+
+    ////////////////////////////////////////////////////////////////////////////
+    //! Merged, non-overlapping, rects covering every chunk changed in epochs
+    //! [@p since, epoch()], clipped to the area.
+    ////////////////////////////////////////////////////////////////////////////
+    std::vector<rect_t> changed_since(epoch_t since) const;
+
+    //! whether any chunk was changed in epochs [@p since, epoch()].
+    bool is_changed_since(epoch_t since) const;
+private:
+    //! OR the bitsets of epochs [since, epoch()] into @p out; false if too old.
+    bool collect_(epoch_t since, std::vector<uint64_t>& out) const;
+
+    //! the index of chunk (cx, cy) in an epoch bitset.
+    size_t bit_(int const cx, int const cy) const {
+        return static_cast<size_t>(cx) + static_cast<size_t>(cy) * row_words_ * 64;
+    }
+
+    int    width_;
+    int    height_;
+    int    chunks_w_;
+    int    chunks_h_;
+    size_t row_words_; //!< words per row of chunks.
+    size_t words_;     //!< words per epoch bitset.
+    size_t current_;   //!< offset of the current epoch's bitset in bits_.
+
+    epoch_t epoch_ = 0;
+
+    std::vector<uint64_t> bits_; //!< history bitsets; epoch e at (e % history) * words_.
+};
+
+} //namespace yama
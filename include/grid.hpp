@@ -5,22 +5,217 @@
 
 #include "assert.hpp"
 #include "types.hpp"
+#include "map_view.hpp"
 
 namespace yama {
 
+////////////////////////////////////////////////////////////////////////////////
+//! Row-major storage layout; the default for grid.
+////////////////////////////////////////////////////////////////////////////////
+class flat_layout {
+public:
+    flat_layout(int const Width, int const Height)
+      : width_  {Width}
+      , height_ {Height}
+    {
+    }
+
+    //! the number of Ts required to store the grid.
+    size_t size() const {
+        return static_cast<size_t>(width_) * static_cast<size_t>(height_);
+    }
+
+    size_t index_of(int const x, int const y) const {
+        return static_cast<size_t>(x) + static_cast<size_t>(y) * static_cast<size_t>(width_);
+    }
+
+    //! call function(x, y, index) for every position in storage order.
+    template <typename F>
+    void for_each(F&& function) const {
+        size_t i = 0;
+        for (auto yi = 0; yi < height_; ++yi) {
+            for (auto xi = 0; xi < width_; ++xi, ++i) {
+                function(xi, yi, i);
+            }
+        }
+    }
+private:
+    int width_;
+    int height_;
+};
+
+namespace detail {
+
+//! spread the low 16 bits of n to the even bits of the result.
+inline uint32_t morton_spread(uint32_t n) {
+    n &= 0x0000FFFF;
+    n = (n | (n << 8)) & 0x00FF00FF;
+    n = (n | (n << 4)) & 0x0F0F0F0F;
+    n = (n | (n << 2)) & 0x33333333;
+    n = (n | (n << 1)) & 0x55555555;
+    return n;
+}
+
+//! inverse of morton_spread.
+inline uint32_t morton_compact(uint32_t n) {
+    n &= 0x55555555;
+    n = (n | (n >> 1)) & 0x33333333;
+    n = (n | (n >> 2)) & 0x0F0F0F0F;
+    n = (n | (n >> 4)) & 0x00FF00FF;
+    n = (n | (n >> 8)) & 0x0000FFFF;
+    return n;
+}
+
+//! @return the smallest k such that (1 << k) >= n.
+inline int ceil_log2(int const n) {
+    int k = 0;
+    while ((1 << k) < n) {
+        ++k;
+    }
+    return k;
+}
+
+} //namespace detail
+
+////////////////////////////////////////////////////////////////////////////////
+//! Chunked storage layout; square chunks of (1 << ChunkBits) tiles per side
+//! are stored contiguously (row-major within a chunk), and the chunks
+//! themselves are stored in Z (Morton) order.
+//!
+//! The chunk grid is padded up to a power of two in each dimension. When the
+//! chunk grid isn't square, only the low bits common to both dimensions are
+//! interleaved; the remaining high bits of the longer dimension select a
+//! square block of chunks. Storage is therefore never larger than the padded
+//! chunk grid.
+//!
+//! The x and y contributions to an index occupy disjoint bits, so they are
+//! precomputed per column and per row; an index is then two loads and an add.
+////////////////////////////////////////////////////////////////////////////////
+template <int ChunkBits = 4>
+class chunked_layout {
+    static_assert(ChunkBits > 0 && ChunkBits <= 8, "");
+public:
+    static int const chunk_bits = ChunkBits;
+    static int const chunk_size = 1 << ChunkBits;
+    static int const chunk_mask = chunk_size - 1;
+
+    chunked_layout(int const Width, int const Height)
+      : width_  {Width}
+      , height_ {Height}
+      , bits_x_ {detail::ceil_log2((Width  + chunk_mask) >> chunk_bits)}
+      , bits_y_ {detail::ceil_log2((Height + chunk_mask) >> chunk_bits)}
+      , shared_bits_ {std::min(bits_x_, bits_y_)}
+      , offset_x_ (static_cast<size_t>(Width))
+      , offset_y_ (static_cast<size_t>(Height))
+    {
+        BK_ASSERT(bits_x_ <= 16 && bits_y_ <= 16);
+
+        auto const mask = (uint32_t {1} << shared_bits_) - 1;
+
+        //the bits of the chunk index contributed by chunk column / row c.
+        auto const chunk_bits_of = [&](uint32_t const c, int const shift, bool const is_long) {
+            auto const low  = static_cast<size_t>(detail::morton_spread(c & mask)) << shift;
+            auto const high = is_long
+              ? static_cast<size_t>(c >> shared_bits_) << (2*shared_bits_)
+              : size_t {0};
+
+            return (low | high) << (2*chunk_bits);
+        };
+
+        for (int x = 0; x < Width; ++x) {
+            auto const c = static_cast<uint32_t>(x) >> chunk_bits;
+            offset_x_[x] = chunk_bits_of(c, 0, bits_x_ > bits_y_)
+                         | static_cast<size_t>(x & chunk_mask);
+        }
+
+        for (int y = 0; y < Height; ++y) {
+            auto const c = static_cast<uint32_t>(y) >> chunk_bits;
+            offset_y_[y] = chunk_bits_of(c, 1, bits_x_ <= bits_y_)
+                         | static_cast<size_t>((y & chunk_mask) << chunk_bits);
+        }
+    }
+
+    //! the number of Ts required to store the grid (including padding).
+    size_t size() const {
+        return size_t {1} << (bits_x_ + bits_y_ + 2*chunk_bits);
+    }
+
+    size_t index_of(int const x, int const y) const {
+        return offset_x_[x] + offset_y_[y];
+    }
+
+    //! call function(x, y, index) for every position in storage order; that
+    //! is, chunk by chunk.
+    template <typename F>
+    void for_each(F&& function) const {
+        auto const chunks = size_t {1} << (bits_x_ + bits_y_);
+
+        for (size_t c = 0; c < chunks; ++c) {
+            uint32_t cx, cy;
+            chunk_position_(c, cx, cy);
+
+            auto const x0 = static_cast<int>(cx << chunk_bits);
+            auto const y0 = static_cast<int>(cy << chunk_bits);
+            if (x0 >= width_ || y0 >= height_) {
+                continue; //padding
+            }
+
+            auto const x1 = std::min(x0 + chunk_size, width_);
+            auto const y1 = std::min(y0 + chunk_size, height_);
+            auto const base = c << (2*chunk_bits);
+
+            for (auto yi = y0; yi < y1; ++yi) {
+                auto i = base + static_cast<size_t>((yi - y0) << chunk_bits);
+                for (auto xi = x0; xi < x1; ++xi, ++i) {
+                    function(xi, yi, i);
+                }
+            }
+        }
+    }
+private:
+    void chunk_position_(size_t const c, uint32_t& cx, uint32_t& cy) const {
+        auto const low  = static_cast<uint32_t>(c & ((size_t {1} << (2*shared_bits_)) - 1));
+        auto const high = static_cast<uint32_t>(c >> (2*shared_bits_)) << shared_bits_;
+
+        cx = detail::morton_compact(low);
+        cy = detail::morton_compact(low >> 1);
+
+        if (bits_x_ > bits_y_) {
+            cx |= high;
+        } else {
+            cy |= high;
+        }
+    }
+
+    int width_;
+    int height_;
+    int bits_x_;      //!< log2 of the padded chunk grid width.
+    int bits_y_;      //!< log2 of the padded chunk grid height.
+    int shared_bits_; //!< the number of interleaved bits.
+
+    std::vector<size_t> offset_x_; //!< index contribution of each column.
+    std::vector<size_t> offset_y_; //!< index contribution of each row.
+};
+
 ////////////////////////////////////////////////////////////////////////////////
 //! 2D grid of Ts
+//!
+//! @tparam Layout The storage layout policy; flat_layout or chunked_layout.
 ////////////////////////////////////////////////////////////////////////////////
-template <typename T>
+template <typename T, typename Layout = flat_layout>
 class grid {
 public:
+    using value_type  = T;
+    using layout_type = Layout;
+
     grid(int const Width, int const Height, T const value = {})
       : width_  {Width}
       , height_ {Height}
+      , layout_ {Width, Height}
       , data_   {}
     {
         BK_ASSERT(width_ > 0 && height_ > 0);
-        data_.resize(width_*height_, value);
+        data_.resize(layout_.size(), value);
     }
 
     bool is_valid_index(int const x, int const y) const {
@@ -52,6 +247,42 @@ public:
         return (*this)(p.x, p.y);
     }
 
+    //! pointer to the first value of row @p y; flat_layout only.
+    T const* row(int const y) const {
+        static_assert(std::is_same<Layout, flat_layout>::value, "rows are only contiguous with flat_layout");
+        BK_ASSERT(y >= 0 && y < height_);
+        return data_.data() + static_cast<size_t>(y) * static_cast<size_t>(width_);
+    }
+
+    //! pointer to the first value of row @p y; flat_layout only.
+    T* row(int const y) {
+        static_assert(std::is_same<Layout, flat_layout>::value, "rows are only contiguous with flat_layout");
+        BK_ASSERT(y >= 0 && y < height_);
+        return data_.data() + static_cast<size_t>(y) * static_cast<size_t>(width_);
+    }
+
+    //! A read-only view of the values; flat_layout only.
+    dense_view<T> view() const {
+        static_assert(std::is_same<Layout, flat_layout>::value, "rows are only contiguous with flat_layout");
+        return {data_.data(), width_, height_, width_};
+    }
+
+    //! call function(x, y, value) for every position in storage order.
+    template <typename F>
+    void for_each_xy(F&& function) const {
+        layout_.for_each([&](int const x, int const y, size_t const i) {
+            function(x, y, data_[i]);
+        });
+    }
+
+    //! call function(x, y, value&) for every position in storage order.
+    template <typename F>
+    void for_each_xy(F&& function) {
+        layout_.for_each([&](int const x, int const y, size_t const i) {
+            function(x, y, data_[i]);
+        });
+    }
+
 //    T at_or(int const x, int const y, T const value = T {}) const {
 //        if (is_valid_index(x, y)) {
 //            return value;
@@ -69,25 +300,30 @@ public:
 private:
     size_t index_of_(int x, int y) const {
         BK_ASSERT(is_valid_index(x, y));
-        return x + y*width_;
+        return layout_.index_of(x, y);
     }
 
-    int width_;
-    int height_;
+    int    width_;
+    int    height_;
+    Layout layout_;
 
     std::vector<T> data_;
 };
 
-template <typename T, typename F>
-void for_each_xy(T&& grid, F&& function) {
-    auto const w = grid.width();
-    auto const h = grid.height();
+////////////////////////////////////////////////////////////////////////////////
+//! A grid stored in Morton ordered chunks; see chunked_layout.
+////////////////////////////////////////////////////////////////////////////////
+template <typename T, int ChunkBits = 4>
+using chunked_grid = grid<T, chunked_layout<ChunkBits>>;
 
-    for (auto yi = 0; yi < h; ++yi) {
-        for (auto xi = 0; xi < w; ++xi) {
-            function(xi, yi, grid(xi, yi));
-        }
-    }
+template <typename T, typename Layout, typename F>
+void for_each_xy(grid<T, Layout> const& grid, F&& function) {
+    grid.for_each_xy(std::forward<F>(function));
+}
+
+template <typename T, typename Layout, typename F>
+void for_each_xy(grid<T, Layout>& grid, F&& function) {
+    grid.for_each_xy(std::forward<F>(function));
 }
 
 template <typename T, typename F>
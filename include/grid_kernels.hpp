@@ -0,0 +1,205 @@
+////////////////////////////////////////////////////////////////////////////////
+//! @file
+//! Vectorized bulk operations on grids of small integral (or enum) values.
+//!
+//! The row kernels are built for AVX2 or SSE2 when the compiler targets them,
+//! and as plain loops otherwise; see grid_kernels_isa().
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "assert.hpp"
+#include "types.hpp"
+#include "grid.hpp"
+
+namespace yama {
+
+namespace detail {
+
+template <size_t Size> struct kernel_word;
+template <> struct kernel_word<1> { using type = uint8_t;  };
+template <> struct kernel_word<2> { using type = uint16_t; };
+template <> struct kernel_word<4> { using type = uint32_t; };
+
+//! the unsigned integer the kernels treat a T as.
+template <typename T>
+using kernel_word_t = typename kernel_word<sizeof(T)>::type;
+
+template <typename T>
+inline kernel_word_t<T> to_kernel_word(T const value) {
+    static_assert(std::is_integral<T>::value || std::is_enum<T>::value, "");
+    return static_cast<kernel_word_t<T>>(value);
+}
+
+template <typename T>
+inline kernel_word_t<T> const* to_kernel_words(T const* const p) {
+    return reinterpret_cast<kernel_word_t<T> const*>(p);
+}
+
+template <typename T>
+inline kernel_word_t<T>* to_kernel_words(T* const p) {
+    return reinterpret_cast<kernel_word_t<T>*>(p);
+}
+
+//! Row kernels; instantiated in grid_kernels.cpp for uint8_t, uint16_t and uint32_t.
+template <typename U> size_t count_equal_row(U const* row, size_t n, U value);
+template <typename U> void   replace_row(U* row, size_t n, U from, U to);
+template <typename U> size_t diff_mask_row(U const* a, U const* b, size_t n, uint8_t* out);
+template <typename U> void   histogram_rows(U const* row, size_t stride, size_t n, size_t rows, size_t* counts, int bins);
+
+template <typename T>
+inline bool contains(grid<T> const& g, rect_t const r) {
+    return r.left >= 0 && r.top >= 0 && r.left <= r.right && r.top <= r.bottom
+        && r.right <= g.width() && r.bottom <= g.height();
+}
+
+//! the number of values in the grid; rows are contiguous, so this is also the
+//! length of the single row starting at row(0).
+template <typename T>
+inline size_t size_of(grid<T> const& g) {
+    return static_cast<size_t>(g.width()) * static_cast<size_t>(g.height());
+}
+
+} //namespace detail
+
+//! the instruction set the row kernels were built for: "avx2", "sse2" or "scalar".
+char const* grid_kernels_isa();
+
+////////////////////////////////////////////////////////////////////////////////
+//! the number of values in @p r equal to @p value.
+////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+size_t count_if_equal(grid<T> const& g, rect_t const r, T const value) {
+    BK_ASSERT(detail::contains(g, r));
+
+    size_t result = 0;
+    for (auto y = r.top; y < r.bottom; ++y) {
+        result += detail::count_equal_row(detail::to_kernel_words(g.row(y) + r.left)
+          , static_cast<size_t>(r.width()), detail::to_kernel_word(value));
+    }
+
+    return result;
+}
+
+//!
+template <typename T>
+size_t count_if_equal(grid<T> const& g, T const value) {
+    return detail::count_equal_row(detail::to_kernel_words(g.row(0))
+      , detail::size_of(g), detail::to_kernel_word(value));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! replace every @p from in @p r with @p to.
+////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+void replace(grid<T>& g, rect_t const r, T const from, T const to) {
+    BK_ASSERT(detail::contains(g, r));
+
+    for (auto y = r.top; y < r.bottom; ++y) {
+        detail::replace_row(detail::to_kernel_words(g.row(y) + r.left)
+          , static_cast<size_t>(r.width()), detail::to_kernel_word(from), detail::to_kernel_word(to));
+    }
+}
+
+//!
+template <typename T>
+void replace(grid<T>& g, T const from, T const to) {
+    detail::replace_row(detail::to_kernel_words(g.row(0))
+      , detail::size_of(g), detail::to_kernel_word(from), detail::to_kernel_word(to));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! set every value in @p r to @p value.
+////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+void fill_rect(grid<T>& g, rect_t const r, T const value) {
+    BK_ASSERT(detail::contains(g, r));
+
+    for (auto y = r.top; y < r.bottom; ++y) {
+        std::fill_n(g.row(y) + r.left, r.width(), value);
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! whether @p r holds the same values in @p a and @p b.
+////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+bool equal(grid<T> const& a, grid<T> const& b, rect_t const r) {
+    BK_ASSERT(detail::contains(a, r) && detail::contains(b, r));
+
+    auto const bytes = sizeof(T) * static_cast<size_t>(r.width());
+    for (auto y = r.top; y < r.bottom; ++y) {
+        if (std::memcmp(a.row(y) + r.left, b.row(y) + r.left, bytes) != 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//! whether @p a and @p b are the same size and hold the same values.
+template <typename T>
+bool equal(grid<T> const& a, grid<T> const& b) {
+    return a.width() == b.width() && a.height() == b.height()
+        && std::memcmp(a.row(0), b.row(0), sizeof(T) * detail::size_of(a)) == 0;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Set @p out to 1 where @p a and @p b differ within @p r and to 0 where they
+//! are the same; @p out is left unchanged outside of @p r.
+//!
+//! @returns the number of differing values.
+////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+size_t diff_mask(grid<T> const& a, grid<T> const& b, rect_t const r, grid<uint8_t>& out) {
+    BK_ASSERT(detail::contains(a, r) && detail::contains(b, r) && detail::contains(out, r));
+
+    size_t result = 0;
+    for (auto y = r.top; y < r.bottom; ++y) {
+        result += detail::diff_mask_row(detail::to_kernel_words(a.row(y) + r.left)
+          , detail::to_kernel_words(b.row(y) + r.left), static_cast<size_t>(r.width()), out.row(y) + r.left);
+    }
+
+    return result;
+}
+
+//! @pre a, b and out are the same size.
+template <typename T>
+size_t diff_mask(grid<T> const& a, grid<T> const& b, grid<uint8_t>& out) {
+    BK_ASSERT(a.width() == b.width() && a.height() == b.height());
+    BK_ASSERT(a.width() == out.width() && a.height() == out.height());
+
+    return detail::diff_mask_row(detail::to_kernel_words(a.row(0))
+      , detail::to_kernel_words(b.row(0)), detail::size_of(a), out.row(0));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Add the number of occurrences of each value in [0, bins) within @p r to
+//! @p counts; values outside of [0, bins) aren't counted.
+//!
+//! @pre counts has room for bins values.
+////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+void histogram(grid<T> const& g, rect_t const r, size_t* const counts, int const bins) {
+    BK_ASSERT(detail::contains(g, r));
+
+    if (r.width() <= 0 || r.height() <= 0) {
+        return;
+    }
+
+    detail::histogram_rows(detail::to_kernel_words(g.row(r.top) + r.left)
+      , static_cast<size_t>(g.width()), static_cast<size_t>(r.width())
+      , static_cast<size_t>(r.height()), counts, bins);
+}
+
+//!
+template <typename T>
+void histogram(grid<T> const& g, size_t* const counts, int const bins) {
+    auto const n = detail::size_of(g);
+    detail::histogram_rows(detail::to_kernel_words(g.row(0)), n, n, size_t {1}, counts, bins);
+}
+
+} //namespace yama
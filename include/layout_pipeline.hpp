@@ -0,0 +1,154 @@
+////////////////////////////////////////////////////////////////////////////////
+//! @file
+//! bsp_layout generation as a pipeline of swappable, timed, memoized stages.
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "detail/bsp_layout_impl.hpp"
+
+namespace yama {
+
+////////////////////////////////////////////////////////////////////////////////
+//! The steps of bsp_layout::generate_into as separate stages:
+//!
+//!   tree -> rooms -> rasterize -> corridors -> features
+//!
+//! Each stage is a function from the output of the stage(s) before it to its
+//! own output; any of them can be replaced, e.g. by another room shape or
+//! corridor router. Stages are given the layout (for its params_t and
+//! helpers; its map_ is the map being generated) and the random stream as the
+//! previous stage left it.
+//!
+//! The output of every stage is kept along with the state of the random stream
+//! after it. Generating the same seed with the same params again only re-runs
+//! the stages replaced (or invalidated) since, and those after them. With the
+//! default stages the levels are the same as bsp_layout's when
+//! params_t::subtree_area is 0.
+////////////////////////////////////////////////////////////////////////////////
+class layout_pipeline {
+public:
+    using layout_t = detail::bsp_layout_impl;
+    using params_t = layout_t::params_t;
+    using node     = layout_t::node;
+    using clock    = std::chrono::high_resolution_clock;
+    using duration = clock::duration;
+
+    enum class stage : int {
+        tree, rooms, rasterize, corridors, features
+    };
+
+    static int const stage_count = 5;
+
+    static char const* stage_name(stage s);
+
+    //! Output of the tree stage; nodes[0] is the root.
+    struct tree_t {
+        std::vector<node> nodes;
+    };
+
+    //! Output of the rooms stage; the tree with the index of its room as the
+    //! data of each leaf that has one.
+    struct rooms_t {
+        std::vector<node>   nodes;
+        std::vector<rect_t> rooms;
+    };
+
+    //! Output of the features stage, besides the map.
+    struct features_t {
+        std::vector<grid_position_t> stairs;
+    };
+
+    //! Splits the bounds of the map into a tree.
+    using tree_stage = std::function<void (layout_t&, random_t&, rect_t bounds, tree_t& out)>;
+
+    //! Places rooms in the leaves of the tree.
+    using rooms_stage = std::function<void (layout_t&, random_t&, tree_t const& in, rooms_t& out)>;
+
+    //! Writes the rooms to @p out; a cleared map.
+    using rasterize_stage = std::function<void (layout_t&, random_t&, rooms_t const& in, map& out)>;
+
+    //! Adds corridors between the rooms to @p out; as rasterize left it.
+    using corridors_stage = std::function<void (layout_t&, random_t&, rooms_t const& in, map& out)>;
+
+    //! Adds stairs and such to @p out; as corridors left it.
+    using features_stage = std::function<void (layout_t&, random_t&, rooms_t const& in, map& out, features_t& features)>;
+
+    //! The default stages: those of bsp_layout.
+    static tree_stage      default_tree();
+    static rooms_stage     default_rooms();
+    static rasterize_stage default_rasterize();
+    static corridors_stage default_corridors();
+    static features_stage  default_features();
+
+    //! How a stage went in the last generate_into.
+    struct stage_report {
+        duration time   {}; //!< the time the stage took; zero if memoized.
+        bool     cached {}; //!< the memoized output was used.
+    };
+
+    using report_t = std::array<stage_report, stage_count>;
+
+    explicit layout_pipeline(params_t params = params_t {});
+
+    params_t params() const;
+
+    //! Also invalidates every stage.
+    void set_params(params_t params);
+
+    //! Replacing a stage invalidates it and the stages after it.
+    void set_tree_stage(tree_stage f);
+    void set_rooms_stage(rooms_stage f);
+    void set_rasterize_stage(rasterize_stage f);
+    void set_corridors_stage(corridors_stage f);
+    void set_features_stage(features_stage f);
+
+    //! Forget the output of @p s and of the stages after it.
+    void invalidate(stage s);
+
+    //! Generate the level for @p seed into @p out; reused if it is the right
+    //! size.
+    void generate_into(map& out, uint32_t seed);
+
+    map generate(uint32_t seed);
+
+    //! The last level's rooms and features; valid after generate_into.
+    rooms_t const&    rooms()    const { return rooms_; }
+    features_t const& features() const { return features_; }
+
+    report_t const& last_report() const { return report_; }
+private:
+    //! The state after a stage; tiles only for stages writing the map.
+    struct memo_t {
+        bool                       valid = false;
+        random_t                   random;
+        std::vector<tile_category> tiles;
+    };
+
+    //! the first stage without a memoized output.
+    int first_invalid_() const;
+
+    layout_t layout_;
+
+    tree_stage      tree_stage_;
+    rooms_stage     rooms_stage_;
+    rasterize_stage rasterize_stage_;
+    corridors_stage corridors_stage_;
+    features_stage  features_stage_;
+
+    uint32_t seed_ = 0; //!< the seed of the memoized outputs.
+
+    tree_t     tree_;
+    rooms_t    rooms_;
+    features_t features_;
+
+    std::array<memo_t, stage_count> memo_;
+    report_t                        report_;
+};
+
+} //namespace yama
@@ -6,6 +6,10 @@
 
 #include "bsp_layout.hpp"
 
+#include <algorithm>
+#include <array>
+#include <vector>
+
 namespace yama {
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -24,35 +28,73 @@ public:
         regions_ = layout.get_regions();
     }
 
+    ////////////////////////////////////////////////////////////////////////////
+    //! Tiles are bucketed by category, runs of the same category in a row
+    //! becoming one rect, then each bucket is drawn with a single call.
+    ////////////////////////////////////////////////////////////////////////////
     void render(renderer& r) {
+        using category = yama::tile_category;
+
+        int const tile_size = 16;
+
         auto const w = map_.width();
         auto const h = map_.height();
 
+        for (auto& bucket : buckets_) {
+            bucket.clear();
+        }
+
+        row_.resize(static_cast<size_t>(w));
+
         for (int y = 0; y < h; ++y) {
-            for (int x = 0; x < w; ++x) {
-                auto const cat = map_.get<map_property::category>(x, y);
-
-                using category = yama::tile_category;
-
-                switch (cat) {
-                case category::empty:    r.set_color(0, 0, 0); break;
-                case category::wall:     r.set_color(100, 100, 100); break;
-                case category::floor:    r.set_color(200, 200, 200); break;
-                case category::door:     r.set_color(0, 0, 200); break;
-                case category::corridor: r.set_color(0, 100, 0); break;
-                case category::stair:    r.set_color(255, 0, 0); break;
-                case category::invalid:  r.set_color(100, 100, 200); break;
-                default:                 r.set_color(100, 100, 200); break;
+            map_.read_row<map_property::category>(y, row_.data());
+
+            for (int x = 0; x < w; ) {
+                auto const cat = row_[static_cast<size_t>(x)];
+
+                auto end = x + 1;
+                while (end < w && row_[static_cast<size_t>(end)] == cat) {
+                    ++end;
                 }
 
-                r.fill_rect(x*16, y*16, 16, 16);
+                //unknown categories are drawn as invalid
+                auto const i = std::min(static_cast<size_t>(cat), static_cast<size_t>(category::invalid));
+                buckets_[i].push_back(renderer::int_rect {
+                    x * tile_size, y * tile_size, (end - x) * tile_size, tile_size});
+
+                x = end;
             }
         }
 
-        r.set_color(255, 0, 0);
+        for (size_t i = 0; i < buckets_.size(); ++i) {
+            auto const& bucket = buckets_[i];
+            if (bucket.empty()) {
+                continue;
+            }
+
+            switch (static_cast<category>(i)) {
+            case category::empty:    r.set_color(0, 0, 0); break;
+            case category::wall:     r.set_color(100, 100, 100); break;
+            case category::floor:    r.set_color(200, 200, 200); break;
+            case category::door:     r.set_color(0, 0, 200); break;
+            case category::corridor: r.set_color(0, 100, 0); break;
+            case category::stair:    r.set_color(255, 0, 0); break;
+            case category::invalid:  r.set_color(100, 100, 200); break;
+            default:                 r.set_color(100, 100, 200); break;
+            }
+
+            r.fill_rects(bucket.data(), bucket.size());
+        }
+
+        region_rects_.clear();
         for (auto const& region : regions_) {
-            r.draw_rect(region.left*16, region.top*16, region.width()*16, region.height()*16);
+            region_rects_.push_back(renderer::int_rect {
+                region.left * tile_size, region.top * tile_size
+              , region.width() * tile_size, region.height() * tile_size});
         }
+
+        r.set_color(255, 0, 0);
+        r.draw_rects(region_rects_.data(), region_rects_.size());
     }
 
     int width()  const { return map_.width(); }
@@ -60,6 +102,11 @@ public:
 private:
     map map_;
     std::vector<rect_t> regions_;
+
+    //! the rects of each tile_category for render; reused every frame.
+    std::array<std::vector<renderer::int_rect>, static_cast<size_t>(tile_category::invalid) + 1> buckets_;
+    std::vector<renderer::int_rect> region_rects_;
+    std::vector<tile_category>      row_;
 };
 
 } //namespace yama
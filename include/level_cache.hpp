@@ -0,0 +1,63 @@
+////////////////////////////////////////////////////////////////////////////////
+//! @file
+//! On-disk cache of generated levels shared between processes.
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "bsp_layout.hpp"
+#include "level_file.hpp"
+
+namespace yama {
+
+////////////////////////////////////////////////////////////////////////////////
+//! A directory of level files, one per level_key(seed, params), in front of
+//! bsp_layout::generate.
+//!
+//! Files are written to a temporary name and renamed into place, so a file is
+//! either complete or absent and any number of processes can share a
+//! directory. An index, level_cache.index, records the size and last use of
+//! each file; once the files exceed the size limit the least recently used are
+//! removed. The index is only read and written, under a file lock, when a
+//! level is added or many hits have accumulated; until then hits are recorded
+//! in memory.
+//!
+//! pimpl based
+////////////////////////////////////////////////////////////////////////////////
+class level_cache {
+public:
+    ////////////////////////////////////////////////////////////////////////////
+    //! @param directory An existing directory for the level files, the index
+    //!        and level_cache.lock.
+    //! @param max_size The maximum total size, in bytes, of the level files.
+    ////////////////////////////////////////////////////////////////////////////
+    level_cache(std::string directory, uint64_t max_size);
+    ~level_cache();
+
+    ////////////////////////////////////////////////////////////////////////////
+    //! The level generated by bsp_layout {params}.generate(random_t {seed}).
+    //!
+    //! A hit is loaded with load_level_file, so the map is read-only and refers
+    //! to the cached file. On a miss the level is generated and added to the
+    //! cache; the map is then the generated one. A file that can't be read is
+    //! treated as a miss; failing to add a level isn't an error.
+    ////////////////////////////////////////////////////////////////////////////
+    level_file_contents get(uint32_t seed, bsp_layout::params_t const& params);
+
+    //! the path of the file for @p key.
+    std::string file_name(uint64_t key) const;
+
+    //! the total size of the level files, as of the last time one was added.
+    uint64_t size() const;
+
+    uint64_t hits() const;   //!< by this instance.
+    uint64_t misses() const; //!< by this instance.
+private:
+    class impl_t;
+    std::unique_ptr<impl_t> impl_;
+};
+
+} //namespace yama
@@ -0,0 +1,82 @@
+////////////////////////////////////////////////////////////////////////////////
+//! @file
+//! Versioned binary level files loaded by memory mapping.
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "types.hpp"
+#include "map.hpp"
+#include "bsp_layout.hpp"
+
+namespace yama {
+
+//! The level file format version written by save_level_file.
+static constexpr uint32_t level_file_version = 1;
+
+////////////////////////////////////////////////////////////////////////////////
+//! The contents of a level file.
+////////////////////////////////////////////////////////////////////////////////
+struct level_file_contents {
+    map                 level_map; //!< Read-only; references the mapped file.
+    std::vector<rect_t> regions;   //!< The BSP region list.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Write @p m and its BSP @p regions to @p file_name.
+//!
+//! The file is a header giving the size and the offset of every property
+//! column, followed by each column in exactly the layout of map::view<P>(), and
+//! then the region list. Values are written in native (little endian) order.
+////////////////////////////////////////////////////////////////////////////////
+void save_level_file(std::string const& file_name, map const& m, std::vector<rect_t> const& regions);
+
+////////////////////////////////////////////////////////////////////////////////
+//! Map @p file_name into memory read-only.
+//!
+//! The returned map refers directly to the mapped pages; nothing is parsed or
+//! copied, so loading costs only the page faults for the tiles that are read,
+//! and processes loading the same file share its pages. The mapping is kept
+//! alive by the map.
+//!
+//! Throws std::runtime_error if the file isn't a valid level file of the
+//! current version.
+////////////////////////////////////////////////////////////////////////////////
+level_file_contents load_level_file(std::string const& file_name);
+
+//! The level delta file format version written by save_level_delta.
+static constexpr uint32_t level_delta_version = 4;
+
+////////////////////////////////////////////////////////////////////////////////
+//! Write a level as the @p seed and @p params it was generated from plus the
+//! changes made to it since; typically m.journal() for a journaling map.
+////////////////////////////////////////////////////////////////////////////////
+void save_level_delta(
+    std::string           const& file_name
+  , uint32_t                     seed
+  , bsp_layout::params_t  const& params
+  , map_journal           const& journal
+);
+
+////////////////////////////////////////////////////////////////////////////////
+//! Regenerate a level saved by save_level_delta and replay its changes.
+//!
+//! The returned map is journaling, and its journal holds the replayed changes,
+//! so it can be saved again with save_level_delta.
+//!
+//! Throws std::runtime_error if the file isn't a valid level delta file, if it
+//! was saved by another bsp_layout::generator_version or random engine, or if
+//! the changes don't apply to the regenerated map.
+////////////////////////////////////////////////////////////////////////////////
+map load_level_delta(std::string const& file_name);
+
+////////////////////////////////////////////////////////////////////////////////
+//! A 64 bit hash of everything a generated level depends on: @p seed, every
+//! field of @p params, and bsp_layout::generator_version.
+////////////////////////////////////////////////////////////////////////////////
+uint64_t level_key(uint32_t seed, bsp_layout::params_t const& params);
+
+} //namespace yama
@@ -0,0 +1,59 @@
+////////////////////////////////////////////////////////////////////////////////
+//! @file
+//! Quality metrics of generated levels.
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "types.hpp"
+#include "map.hpp"
+
+namespace yama {
+
+////////////////////////////////////////////////////////////////////////////////
+//! Metrics of a level for filtering seeds.
+////////////////////////////////////////////////////////////////////////////////
+struct level_metrics {
+    int stair_distance   = -1; //!< Fewest steps between the stairs; -1 if there aren't two connected stairs.
+    int longest_dead_end = 0;  //!< Corridor tiles leading to the longest dead end.
+};
+
+//! whether a tile can be walked on: floor, corridor, door or stair.
+inline bool is_walkable(tile_category const c) {
+    return c == tile_category::floor
+        || c == tile_category::corridor
+        || c == tile_category::door
+        || c == tile_category::stair;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Measures level_metrics; reusing one analyzer for many levels of the same
+//! size allocates nothing once its buffers have grown.
+//!
+//! A single pass over the rows, three at a time, finds the stairs and the
+//! corridor tiles with at most one walkable neighbor. Each of those is
+//! followed along the corridor to its first junction. A breadth first search
+//! from one stair, marking tiles in a bitset, finds the distance to the other.
+//! The map itself is never copied.
+////////////////////////////////////////////////////////////////////////////////
+class level_analyzer {
+public:
+    level_metrics analyze(map const& m);
+private:
+    //! the number of tiles from the dead end @p p to the first tile that
+    //! isn't a corridor with two walkable neighbors.
+    int dead_end_length_(map const& m, grid_position_t p) const;
+
+    //! the fewest steps from @p from to @p to; -1 if unreachable.
+    int distance_(map const& m, grid_position_t from, grid_position_t to);
+
+    std::vector<tile_category>   rows_[3];
+    std::vector<grid_position_t> dead_ends_;
+    std::vector<uint64_t>        visited_;
+    std::vector<uint32_t>        frontier_;
+    std::vector<uint32_t>        next_;
+};
+
+} //namespace yama
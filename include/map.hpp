@@ -1,17 +1,33 @@
 #pragma once
 
+#include <memory>
+#include <tuple>
+#include <utility>
+
 #include "tile.hpp"
 #include "math.hpp"
+#include "map_view.hpp"
+#include "dirty_tracker.hpp"
 
 namespace yama {
 
 static constexpr int map_min_size = 10;
 using map_size = checked_value<int, check_minimum<int, map_min_size>>;
 
+////////////////////////////////////////////////////////////////////////////////
+//! Per-tile map properties; each is stored as its own contiguous column.
+//!
+//! To add a property: add it here (before count), give it a property_mapping,
+//! and add it to the instantiation list in map.cpp. The property_mapping's
+//! view_type also selects the storage used for the column.
+////////////////////////////////////////////////////////////////////////////////
 enum class map_property {
     category, room_id, texture_id
+  , count //!< not a property; the number of properties.
 };
 
+static constexpr int map_property_count = static_cast<int>(map_property::count);
+
 namespace detail {
 
 template <map_property P> struct property_mapping;
@@ -19,11 +35,35 @@ template <map_property P> struct property_mapping;
 template <>
 struct property_mapping<map_property::category> {
     static auto const property = map_property::category;
-    using type = tile_category;
+    using type      = tile_category;
+    using view_type = packed_view<type, 4>;
+};
+
+template <>
+struct property_mapping<map_property::room_id> {
+    static auto const property = map_property::room_id;
+    using type      = room_id_t;
+    using view_type = dense_view<type>;
+};
+
+template <>
+struct property_mapping<map_property::texture_id> {
+    static auto const property = map_property::texture_id;
+    using type      = texture_id_t;
+    using view_type = dense_view<type>;
+};
+
+template <typename Seq> struct make_views;
+
+template <int... Is>
+struct make_views<std::integer_sequence<int, Is...>> {
+    using type = std::tuple<typename property_mapping<static_cast<map_property>(Is)>::view_type...>;
 };
 
 } //namespace detail
 
+class map_journal;
+
 class map {
 public:
     using property = map_property;
@@ -31,15 +71,69 @@ public:
     template <map_property Property>
     using mapping_t = typename detail::property_mapping<Property>::type;
 
+    template <map_property Property>
+    using view_t = typename detail::property_mapping<Property>::view_type;
+
+    using epoch_t = dirty_tracker::epoch_t;
+
+    //! std::tuple of a view_t for every property, in property order.
+    using views_t = typename detail::make_views<
+        std::make_integer_sequence<int, map_property_count>
+    >::type;
+
     map(map_size width, map_size height);
+
+    ////////////////////////////////////////////////////////////////////////////
+    //! A read-only map over external storage; no copy is made.
+    //!
+    //! @param views A width x height view of every property column.
+    //! @param storage Keeps the memory referenced by @p views alive for the
+    //!        lifetime of the map.
+    ////////////////////////////////////////////////////////////////////////////
+    map(views_t views, std::shared_ptr<void const> storage);
+
     ~map();
 
     map(map&& other);
     map& operator=(map&& rhs);
 
+    //! @pre !is_read_only()
     void clear();
 
+    //! true for maps over external storage; these can't be written to.
+    bool is_read_only() const;
+
+    ////////////////////////////////////////////////////////////////////////////
+    //! Start or stop recording every change made through set, write_rect,
+    //! fill_rect and clear in journal(). Stopping keeps the recorded changes.
+    ////////////////////////////////////////////////////////////////////////////
+    void set_journaling(bool enabled);
+
+    //!
+    bool is_journaling() const;
+
+    //! the changes recorded while journaling.
+    map_journal const& journal() const;
+
     //!
+    map_journal& journal();
+
+    //! the current change epoch; see dirty_tracker.
+    epoch_t epoch() const;
+
+    //! end the current change epoch (e.g. once per frame); returns the new one.
+    epoch_t next_epoch();
+
+    ////////////////////////////////////////////////////////////////////////////
+    //! Merged rects covering every tile changed in epochs [@p since, epoch()]
+    //! at chunk (dirty_tracker::chunk_size) granularity; consumers remember
+    //! epoch() at the time of the call and pass it next time.
+    ////////////////////////////////////////////////////////////////////////////
+    std::vector<rect_t> changed_since(epoch_t since) const;
+
+    //! set property P at (x, y); instantiated in map.cpp for every property.
+    //! Out of line as it journals and marks dirty chunks; bulk writes should
+    //! go through write_rect or fill_rect.
     template <property P>
     void set(int x, int y, mapping_t<P> value);
 
@@ -47,7 +141,7 @@ public:
     template <property P>
     void set(grid_position_t p, mapping_t<P> value);
 
-    //!
+    //! get property P at (x, y); inline, through the map's copy of view().
     template <property P>
     mapping_t<P> get(int x, int y) const;
 
@@ -55,6 +149,36 @@ public:
     template <property P>
     mapping_t<P> get(grid_position_t p) const;
 
+    //! decode row @p y of property P to @p out.
+    //! @pre out has room for width() values.
+    template <property P>
+    void read_row(int y, mapping_t<P>* out) const;
+
+    ////////////////////////////////////////////////////////////////////////////
+    //! A read-only view of property P giving raw row pointers and the stride
+    //! for bulk reads that bypass the per-tile call overhead of get.
+    //!
+    //! The view remains valid until the map is destroyed; writes to the map
+    //! are visible through it.
+    ////////////////////////////////////////////////////////////////////////////
+    template <property P>
+    view_t<P> view() const;
+
+    //! copy property P for every position in @p r to @p out; row-major.
+    //! @pre r is contained by the map; out has room for r.area() values.
+    template <property P>
+    void read_rect(rect_t r, mapping_t<P>* out) const;
+
+    //! copy property P for every position in @p r from @p in; row-major.
+    //! @pre r is contained by the map; in has r.area() values.
+    template <property P>
+    void write_rect(rect_t r, mapping_t<P> const* in);
+
+    //! set property P for every position in @p r to @p value.
+    //! @pre r is contained by the map.
+    template <property P>
+    void fill_rect(rect_t r, mapping_t<P> value);
+
     //!
     bool is_valid_position(int x, int y) const;
 
@@ -68,31 +192,23 @@ public:
 private:
     class impl_t;
     std::unique_ptr<impl_t> impl_;
-
-    tile_category get_category_(int x, int y) const;
-    void set_category_(int x, int y, tile_category value);
+    views_t                 views_; //!< a copy of impl_'s views for get.
 };
 
-template <>
-inline void map::set<map_property::category>(int const x, int const y, tile_category const value) {
-    set_category_(x, y, value);
+//! Properties are compile-time selected; there is no per-tile dispatch.
+template <map_property P>
+inline void map::set(grid_position_t const p, mapping_t<P> const value) {
+    set<P>(p.x, p.y, value);
 }
 
-template <>
-inline void map::set<map_property::category>(grid_position_t const p, tile_category const value) {
-    set_category_(p.x, p.y, value);
+template <map_property P>
+inline map::mapping_t<P> map::get(int const x, int const y) const {
+    return std::get<static_cast<size_t>(P)>(views_)(x, y);
 }
 
-template <>
-inline tile_category
-map::get<map_property::category>(int const x, int const y) const {
-    return get_category_(x, y);
-}
-
-template <>
-inline tile_category
-map::get<map_property::category>(grid_position_t const p) const {
-    return get_category_(p.x, p.y);
+template <map_property P>
+inline map::mapping_t<P> map::get(grid_position_t const p) const {
+    return get<P>(p.x, p.y);
 }
 
 } //namespace yama
@@ -0,0 +1,98 @@
+////////////////////////////////////////////////////////////////////////////////
+//! @file
+//! Journal of the changes made to a map.
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+#include "map.hpp"
+
+namespace yama {
+
+////////////////////////////////////////////////////////////////////////////////
+//! A run of count tiles of row y, starting at x, whose property changed from
+//! old_value to new_value.
+////////////////////////////////////////////////////////////////////////////////
+struct map_delta {
+    int32_t      x;
+    int32_t      y;
+    int32_t      count;
+    map_property property;
+    uint32_t     old_value;
+    uint32_t     new_value;
+};
+
+bool operator==(map_delta const& a, map_delta const& b);
+
+////////////////////////////////////////////////////////////////////////////////
+//! An ordered list of map changes.
+//!
+//! Consecutive changes along a row with the same property, old value and new
+//! value are coalesced into a single run; writes that don't change the value
+//! aren't recorded.
+////////////////////////////////////////////////////////////////////////////////
+class map_journal {
+public:
+    template <map_property P>
+    using mapping_t = map::mapping_t<P>;
+
+    //! record that property P at (x, y) changed from @p old_value to @p new_value.
+    template <map_property P>
+    void record(int const x, int const y, mapping_t<P> const old_value, mapping_t<P> const new_value) {
+        record(P, x, y, static_cast<uint32_t>(old_value), static_cast<uint32_t>(new_value));
+    }
+
+    //!
+    void record(map_property const property, int const x, int const y
+              , uint32_t const old_value, uint32_t const new_value
+    ) {
+        if (old_value == new_value) {
+            return;
+        }
+
+        if (!deltas_.empty()) {
+            auto& last = deltas_.back();
+            if (last.property == property && last.y == y && last.x + last.count == x
+             && last.old_value == old_value && last.new_value == new_value
+            ) {
+                ++last.count;
+                return;
+            }
+        }
+
+        deltas_.push_back(map_delta {x, y, 1, property, old_value, new_value});
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    //! Apply every change, in order, to @p m.
+    //!
+    //! @returns false, leaving @p m partially modified, if a tile doesn't hold
+    //!          the recorded old value; i.e. the journal is for another map.
+    ////////////////////////////////////////////////////////////////////////////
+    bool replay(map& m) const;
+
+    //! write the journal to @p out in a compact binary form.
+    void write(std::ostream& out) const;
+
+    ////////////////////////////////////////////////////////////////////////////
+    //! Read a journal written by write for a @p width by @p height map.
+    //!
+    //! @returns false on malformed input: a run outside the map, or a value that
+    //!          doesn't fit the property's storage.
+    ////////////////////////////////////////////////////////////////////////////
+    bool read(std::istream& in, int width, int height);
+
+    std::vector<map_delta> const& deltas() const { return deltas_; }
+
+    bool   empty() const { return deltas_.empty(); }
+    size_t size()  const { return deltas_.size(); }
+
+    void clear() { deltas_.clear(); }
+private:
+    std::vector<map_delta> deltas_;
+};
+
+} //namespace yama
@@ -0,0 +1,151 @@
+////////////////////////////////////////////////////////////////////////////////
+//! @file
+//! Read-only, non-owning, views of 2D property storage for bulk access.
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+#include "assert.hpp"
+#include "types.hpp"
+
+namespace yama {
+
+////////////////////////////////////////////////////////////////////////////////
+//! Read-only view of a row-major 2D array of Ts; rows are stride() Ts apart.
+////////////////////////////////////////////////////////////////////////////////
+template <typename T>
+class dense_view {
+public:
+    using value_type = T;
+
+    dense_view(T const* const Data, int const Width, int const Height, ptrdiff_t const Stride)
+      : data_   {Data}
+      , width_  {Width}
+      , height_ {Height}
+      , stride_ {Stride}
+    {
+    }
+
+    bool is_valid_index(int const x, int const y) const {
+        return (x >= 0 && x < width_)
+            && (y >= 0 && y < height_);
+    }
+
+    //! pointer to the first value of row @p y.
+    T const* row(int const y) const {
+        BK_ASSERT(y >= 0 && y < height_);
+        return data_ + y * stride_;
+    }
+
+    T operator()(int const x, int const y) const {
+        BK_ASSERT(is_valid_index(x, y));
+        return data_[x + y * stride_];
+    }
+
+    //! copy the values in [x0, x1) of row @p y to @p out.
+    void read_row(int const y, int const x0, int const x1, T* const out) const {
+        BK_ASSERT(x0 >= 0 && x0 <= x1 && x1 <= width_);
+        auto const r = row(y);
+        std::copy(r + x0, r + x1, out);
+    }
+
+    int       width()  const { return width_; }
+    int       height() const { return height_; }
+    ptrdiff_t stride() const { return stride_; }
+private:
+    T const*  data_;
+    int       width_;
+    int       height_;
+    ptrdiff_t stride_; //!< distance between rows in Ts.
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Read-only view of a 2D array of Ts packed Bits to a value into 64 bit
+//! words; each row starts on a word boundary and rows are stride() words apart.
+////////////////////////////////////////////////////////////////////////////////
+template <typename T, int Bits>
+class packed_view {
+    static_assert(Bits == 1 || Bits == 2 || Bits == 4 || Bits == 8, "");
+public:
+    using value_type = T;
+    using word_type  = uint64_t;
+
+    static int const bits            = Bits;
+    static int const values_per_word = 64 / Bits;
+
+    static word_type const value_mask = (word_type {1} << Bits) - 1;
+
+    packed_view(word_type const* const Data, int const Width, int const Height, ptrdiff_t const Stride)
+      : data_   {Data}
+      , width_  {Width}
+      , height_ {Height}
+      , stride_ {Stride}
+    {
+    }
+
+    bool is_valid_index(int const x, int const y) const {
+        return (x >= 0 && x < width_)
+            && (y >= 0 && y < height_);
+    }
+
+    //! pointer to the first word of row @p y.
+    word_type const* row(int const y) const {
+        BK_ASSERT(y >= 0 && y < height_);
+        return data_ + y * stride_;
+    }
+
+    T operator()(int const x, int const y) const {
+        BK_ASSERT(is_valid_index(x, y));
+        return unpack(data_[x / values_per_word + y * stride_], x);
+    }
+
+    //! the value at column @p x given the word containing it.
+    static T unpack(word_type const word, int const x) {
+        return static_cast<T>((word >> ((x % values_per_word) * Bits)) & value_mask);
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    //! Decode the values in [x0, x1) of row @p y to @p out.
+    //!
+    //! @pre out has room for (x1 - x0) values.
+    ////////////////////////////////////////////////////////////////////////////
+    void read_row(int const y, int const x0, int const x1, T* out) const {
+        BK_ASSERT(x0 >= 0 && x0 <= x1 && x1 <= width_);
+
+        auto const* const r = row(y);
+
+        auto x = x0;
+
+        //leading partial word
+        for (; x < x1 && (x % values_per_word) != 0; ++x) {
+            *out++ = unpack(r[x / values_per_word], x);
+        }
+
+        //whole words
+        for (; x + values_per_word <= x1; x += values_per_word) {
+            auto const word = r[x / values_per_word];
+            for (int i = 0; i < values_per_word; ++i) {
+                out[i] = static_cast<T>((word >> (i * Bits)) & value_mask);
+            }
+            out += values_per_word;
+        }
+
+        //trailing partial word
+        for (; x < x1; ++x) {
+            *out++ = unpack(r[x / values_per_word], x);
+        }
+    }
+
+    int       width()  const { return width_; }
+    int       height() const { return height_; }
+    ptrdiff_t stride() const { return stride_; }
+private:
+    word_type const* data_;
+    int              width_;
+    int              height_;
+    ptrdiff_t        stride_; //!< distance between rows in words.
+};
+
+} //namespace yama
@@ -0,0 +1,219 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+
+#include "assert.hpp"
+#include "types.hpp"
+#include "map_view.hpp"
+
+namespace yama {
+
+////////////////////////////////////////////////////////////////////////////////
+//! 2D grid of small Ts packed Bits to a value into 64 bit words.
+//!
+//! Each row starts on a word boundary so rows can be decoded independently.
+//! Values are unpacked on read and written with a masked store; use decode_row
+//! for scans so the shift / mask cost is paid per word rather than per tile.
+//!
+//! @tparam T An integral or enum type whose values all fit in Bits bits.
+//! @tparam Bits The number of bits per value; one of 1, 2, 4 or 8.
+////////////////////////////////////////////////////////////////////////////////
+template <typename T, int Bits = 4>
+class packed_grid {
+    static_assert(Bits == 1 || Bits == 2 || Bits == 4 || Bits == 8, "");
+public:
+    using value_type = T;
+    using word_type  = uint64_t;
+
+    static int const bits            = Bits;
+    static int const values_per_word = 64 / Bits;
+
+    static word_type const value_mask = (word_type {1} << Bits) - 1;
+
+    packed_grid(int const Width, int const Height, T const value = {})
+      : width_  {Width}
+      , height_ {Height}
+      , stride_ {(Width + values_per_word - 1) / values_per_word}
+      , data_   {}
+    {
+        BK_ASSERT(width_ > 0 && height_ > 0);
+        data_.resize(static_cast<size_t>(stride_) * static_cast<size_t>(height_), fill_pattern_(value));
+    }
+
+    bool is_valid_index(int const x, int const y) const {
+        return (x >= 0 && x < width_)
+            && (y >= 0 && y < height_);
+    }
+
+    bool is_valid_index(grid_position_t const p) const {
+        return is_valid_index(p.x, p.y);
+    }
+
+    void clear(T const value = T {}) {
+        std::fill(std::begin(data_), std::end(data_), fill_pattern_(value));
+    }
+
+    T operator()(int const x, int const y) const {
+        auto const word = data_[word_of_(x, y)];
+        return static_cast<T>((word >> shift_of_(x)) & value_mask);
+    }
+
+    T operator[](grid_position_t const p) const {
+        return (*this)(p.x, p.y);
+    }
+
+    void set(int const x, int const y, T const value) {
+        BK_ASSERT(is_valid_index(x, y));
+        set_(row_(y), x, to_bits_(value));
+    }
+
+    void set(grid_position_t const p, T const value) {
+        set(p.x, p.y, value);
+    }
+
+    //! Decode the values in [x0, x1) of row @p y to @p out.
+    void decode_row(int const y, int const x0, int const x1, T* const out) const {
+        view().read_row(y, x0, x1, out);
+    }
+
+    //! Decode all of row @p y to @p out; out must have room for width() values.
+    void decode_row(int const y, T* const out) const {
+        decode_row(y, 0, width_, out);
+    }
+
+    //! Set the values in [x0, x1) of row @p y to @p value.
+    void fill_row(int const y, int const x0, int const x1, T const value) {
+        BK_ASSERT(y >= 0 && y < height_);
+        BK_ASSERT(x0 >= 0 && x0 <= x1 && x1 <= width_);
+
+        auto const pattern = fill_pattern_(value);
+        auto const row     = row_(y);
+
+        //partial words at either end are merged under a mask
+        for_each_word_(x0, x1, [&](int const word, int const first, int const last) {
+            merge_(row[word], pattern, first, last);
+        });
+    }
+
+    //! Encode the values in [x0, x1) of row @p y from @p in.
+    void encode_row(int const y, int const x0, int const x1, T const* in) {
+        BK_ASSERT(y >= 0 && y < height_);
+        BK_ASSERT(x0 >= 0 && x0 <= x1 && x1 <= width_);
+
+        auto const row = row_(y);
+
+        for_each_word_(x0, x1, [&](int const word, int const first, int const last) {
+            word_type value_bits = 0;
+
+            if (last - first == values_per_word) {
+                for (int i = 0; i < values_per_word; ++i) {
+                    value_bits |= to_bits_(in[i]) << (i * Bits);
+                }
+            } else {
+                for (int i = first; i < last; ++i) {
+                    value_bits |= to_bits_(in[i - first]) << (i * Bits);
+                }
+            }
+
+            merge_(row[word], value_bits, first, last);
+            in += last - first;
+        });
+    }
+
+    //! A read-only view of the packed words.
+    packed_view<T, Bits> view() const {
+        return {data_.data(), width_, height_, stride_};
+    }
+
+    //! call function(x, y, value) for every position in row-major order.
+    template <typename F>
+    void for_each_xy(F&& function) const {
+        std::vector<T> buffer (static_cast<size_t>(width_));
+
+        for (auto yi = 0; yi < height_; ++yi) {
+            decode_row(yi, buffer.data());
+            for (auto xi = 0; xi < width_; ++xi) {
+                function(xi, yi, buffer[xi]);
+            }
+        }
+    }
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+private:
+    static word_type to_bits_(T const value) {
+        auto const result = static_cast<word_type>(value);
+        BK_ASSERT(result <= value_mask);
+        return result;
+    }
+
+    static word_type fill_pattern_(T const value) {
+        auto const v = to_bits_(value);
+
+        word_type result = 0;
+        for (int i = 0; i < values_per_word; ++i) {
+            result |= v << (i * Bits);
+        }
+
+        return result;
+    }
+
+    word_type* row_(int const y) {
+        return data_.data() + static_cast<size_t>(y) * static_cast<size_t>(stride_);
+    }
+
+    static void set_(word_type* const row, int const x, word_type const bits) {
+        auto&      word  = row[x / values_per_word];
+        auto const shift = shift_of_(x);
+
+        word = (word & ~(value_mask << shift)) | (bits << shift);
+    }
+
+    //! call function(word, first, last) for each word of a row holding values
+    //! in [x0, x1); values [first, last) of the word are in range.
+    template <typename F>
+    static void for_each_word_(int const x0, int const x1, F&& function) {
+        for (auto x = x0; x < x1;) {
+            auto const first = x % values_per_word;
+            auto const last  = std::min(+values_per_word, first + (x1 - x));
+
+            function(x / values_per_word, first, last);
+            x += last - first;
+        }
+    }
+
+    //! replace values [first, last) of @p word by those of @p bits.
+    static void merge_(word_type& word, word_type const bits, int const first, int const last) {
+        if (last - first == values_per_word) {
+            word = bits;
+            return;
+        }
+
+        auto const mask = ((word_type {1} << ((last - first) * Bits)) - 1) << (first * Bits);
+        word = (word & ~mask) | (bits & mask);
+    }
+
+    static int shift_of_(int const x) {
+        return (x % values_per_word) * Bits;
+    }
+
+    size_t word_of_(int const x, int const y) const {
+        BK_ASSERT(is_valid_index(x, y));
+        return static_cast<size_t>(x / values_per_word)
+             + static_cast<size_t>(y) * static_cast<size_t>(stride_);
+    }
+
+    int width_;
+    int height_;
+    int stride_; //!< words per row.
+
+    std::vector<word_type> data_;
+};
+
+template <typename T, int Bits, typename F>
+void for_each_xy(packed_grid<T, Bits> const& grid, F&& function) {
+    grid.for_each_xy(std::forward<F>(function));
+}
+
+} //namespace yama
@@ -0,0 +1,110 @@
+////////////////////////////////////////////////////////////////////////////////
+//! @file
+//! Sparse, paged, map storage for very large (world) maps.
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "map.hpp"
+
+namespace yama {
+
+////////////////////////////////////////////////////////////////////////////////
+//! A sparse map stored as square chunks of grid<T> columns.
+//!
+//! Chunks are allocated on the first write of a non-default value; until then
+//! every property of every tile in the chunk reads as its default (empty).
+//! When the resident chunks exceed the memory budget, the least recently used
+//! chunk is written to a swap file and freed; it is read back on next use.
+//!
+//! Offers the same get / set<map_property> interface as map. Code written
+//! for map, such as the generators and the renderer, works on a region:
+//! extract copies it out as a map and blit copies a map back in.
+//!
+//! Throws std::runtime_error if the swap file can't be created, read or
+//! written; a chunk that fails to page in or out is left where it was.
+//!
+//! pimpl based
+////////////////////////////////////////////////////////////////////////////////
+class paged_map {
+public:
+    using property = map_property;
+
+    template <map_property Property>
+    using mapping_t = typename detail::property_mapping<Property>::type;
+
+    static int const chunk_bits = 6;
+    static int const chunk_size = 1 << chunk_bits; //!< Chunk width and height.
+
+    ////////////////////////////////////////////////////////////////////////////
+    //! @param memory_budget The maximum number of bytes of resident chunks.
+    //! @param swap_file The path of the swap file; it is created (truncated)
+    //!        and is removed when the paged_map is destroyed.
+    ////////////////////////////////////////////////////////////////////////////
+    paged_map(map_size width, map_size height, size_t memory_budget, std::string swap_file);
+    ~paged_map();
+
+    paged_map(paged_map&& other);
+    paged_map& operator=(paged_map&& rhs);
+
+    //! free every chunk; every tile reads as empty.
+    void clear();
+
+    //! set property P at (x, y); instantiated in paged_map.cpp for every property.
+    template <property P>
+    void set(int x, int y, mapping_t<P> value);
+
+    //!
+    template <property P>
+    void set(grid_position_t const p, mapping_t<P> const value) {
+        set<P>(p.x, p.y, value);
+    }
+
+    //! get property P at (x, y); may page the chunk in from the swap file.
+    template <property P>
+    mapping_t<P> get(int x, int y) const;
+
+    //!
+    template <property P>
+    mapping_t<P> get(grid_position_t const p) const {
+        return get<P>(p.x, p.y);
+    }
+
+    //! read property P of [x0, x1) of row @p y into @p out.
+    //! @pre the row segment is contained by this map.
+    template <property P>
+    void read_row(int x0, int x1, int y, mapping_t<P>* out) const;
+
+    //! copy every property of @p source to the region at (x, y).
+    //! @pre the region is contained by this map.
+    void blit(map const& source, int x, int y);
+
+    //! copy every property of the region @p r to a new map; the inverse of blit.
+    //! @pre @p r is non-empty and contained by this map.
+    map extract(rect_t r) const;
+
+    //!
+    bool is_valid_position(int x, int y) const;
+
+    //!
+    bool is_valid_position(grid_position_t const p) const {
+        return is_valid_position(p.x, p.y);
+    }
+
+    int width() const;
+    int height() const;
+
+    size_t allocated_chunks() const; //!< Chunks either resident or swapped out.
+    size_t resident_chunks() const;  //!< Chunks in memory.
+    static size_t chunk_bytes();     //!< Bytes of memory used by one chunk.
+private:
+    paged_map(paged_map const&) = delete;
+    paged_map& operator=(paged_map const&) = delete;
+
+    class impl_t;
+    std::unique_ptr<impl_t> impl_;
+};
+
+} //namespace yama
@@ -1,39 +1,188 @@
 #pragma once
 
 #include "types.hpp"
+#include "random_engine.hpp"
 #include "math.hpp"
 
+#include <limits>
+
 ////////////////////////////////////////////////////////////////////////////////
 //! @file
-//! Random number generation.
+//! Random number generation; the engines are in random_engine.hpp.
 ////////////////////////////////////////////////////////////////////////////////
 
 namespace yama {
 
+namespace detail {
+
+////////////////////////////////////////////////////////////////////////////////
+//! 32 uniform random bits: the value of a 32 bit engine, or the high bits of a
+//! 64 bit one.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Random>
+inline uint32_t random_bits32(Random& random) {
+    using result_t = typename Random::result_type;
+
+    static_assert(Random::min() == 0, "");
+    static_assert(Random::max() == 0xffffffffu
+               || Random::max() == std::numeric_limits<uint64_t>::max(), "");
+
+    auto const value = static_cast<uint64_t>(static_cast<result_t>(random()));
+    return static_cast<uint32_t>(Random::max() == 0xffffffffu ? value : (value >> 32));
+}
+
+//! the values with a biased product, rejected by bounded_random; computed
+//! only when a value falls below @p range.
+inline uint32_t bounded_threshold(uint32_t const range) {
+    return (0u - range) % range;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! A uniform value in [0, @p range) by Lemire's nearly divisionless method;
+//! @p range 0 is the full 2^32. The same on every platform given the same
+//! engine values.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Random>
+inline uint32_t bounded_random(Random& random, uint32_t const range) {
+    if (!range) {
+        return random_bits32(random);
+    }
+
+    auto m = uint64_t {random_bits32(random)} * range;
+
+    if (static_cast<uint32_t>(m) < range) {
+        auto const t = bounded_threshold(range);
+        while (static_cast<uint32_t>(m) < t) {
+            m = uint64_t {random_bits32(random)} * range;
+        }
+    }
+
+    return static_cast<uint32_t>(m >> 32);
+}
+
+} //namespace detail
+
+//! a uniform value in [@p low, @p hi].
+template <typename Random>
+inline int random_uniform(Random& random, int const low, int const hi) {
+    BK_ASSERT(low <= hi);
+
+    auto const range = static_cast<uint32_t>(hi) - static_cast<uint32_t>(low) + 1u;
+    return static_cast<int>(static_cast<uint32_t>(low) + detail::bounded_random(random, range));
+}
+
 template <typename Random, typename T>
-inline auto random_uniform(
+inline int random_uniform(
     Random& random
   , closed_integral_interval<T> const range
 ) {
-    return std::uniform_int_distribution<>{range.lower, range.upper}(random);
+    return random_uniform(random, static_cast<int>(range.lower), static_cast<int>(range.upper));
 }
 
+////////////////////////////////////////////////////////////////////////////////
+//! Fill [@p out, @p out + @p n) with uniform values in [@p low, @p hi]; the
+//! same values as n calls to random_uniform, with the rejection threshold
+//! computed once.
+////////////////////////////////////////////////////////////////////////////////
 template <typename Random>
-inline int random_uniform(Random& random, int const low, int const hi) {
-    return std::uniform_int_distribution<>{low, hi}(random);
+inline void random_uniform_n(Random& random, int const low, int const hi, int* const out, size_t const n) {
+    BK_ASSERT(low <= hi);
+
+    auto const range = static_cast<uint32_t>(hi) - static_cast<uint32_t>(low) + 1u;
+    auto const base  = static_cast<uint32_t>(low);
+
+    if (range == 0) {
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = static_cast<int>(detail::random_bits32(random));
+        }
+        return;
+    }
+
+    auto const t = detail::bounded_threshold(range);
+
+    for (size_t i = 0; i < n; ++i) {
+        auto m = uint64_t {detail::random_bits32(random)} * range;
+        while (static_cast<uint32_t>(m) < t) {
+            m = uint64_t {detail::random_bits32(random)} * range;
+        }
+
+        out[i] = static_cast<int>(base + static_cast<uint32_t>(m >> 32));
+    }
 }
 
 template <typename Random>
 inline bool random_bool(Random& random) {
-    return std::uniform_int_distribution<>{0, 1}(random) == 1;
+    return (detail::random_bits32(random) >> 31) != 0;
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 //! Roll a percentage [0, 100] -> 101 values
 ////////////////////////////////////////////////////////////////////////////////
-template <typename T = int, typename Random>
+template <typename Random>
 inline int random_percent(Random& random) {
-    return std::uniform_int_distribution<T>{0, 100}(random);
+    return static_cast<int>(detail::bounded_random(random, 101));
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Counter based randomness: 32 random bits that depend only on @p seed, the
+//! tile (@p x, @p y) and @p purpose (one for each kind of decision), never on
+//! the draws before. Any tile, row or chunk gives the same values generated
+//! alone, in any order or on any thread.
+//!
+//! Philox-4x32-10 of the counter {x / 4, y, purpose, 0} keyed by @p seed; the
+//! four words of each counter go to four adjacent tiles.
+////////////////////////////////////////////////////////////////////////////////
+inline uint32_t hash_random(uint64_t const seed, int const x, int const y, uint32_t const purpose) {
+    philox4x32 const philox {{{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)}}};
+
+    auto const ux = static_cast<uint32_t>(x);
+    return philox({{ux >> 2, static_cast<uint32_t>(y), purpose, 0}})[ux & 3];
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! hash_random for the @p n tiles of row @p y from @p x, into @p out; several
+//! counters are evaluated at a time.
+////////////////////////////////////////////////////////////////////////////////
+inline void hash_random_row(
+    uint64_t const seed
+  , int      const x
+  , int      const y
+  , uint32_t const purpose
+  , uint32_t* const out
+  , size_t    const n
+) {
+    philox4x32 const philox {{{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)}}};
+
+    size_t const lanes = 16;
+
+    auto const first = static_cast<uint32_t>(x);
+    auto const skip  = first & 3; //!< words of the first counter before x
+
+    uint32_t c[4][lanes];
+
+    for (size_t i = 0; i < n + skip; i += 4 * lanes) {
+        auto const block = (first >> 2) + static_cast<uint32_t>(i / 4);
+
+        //x / 4 of a 32 bit x has 30 bits; rows crossing x = 0 wrap around
+        for (size_t j = 0; j < lanes; ++j) {
+            c[0][j] = (block + static_cast<uint32_t>(j)) & 0x3fffffffu;
+            c[1][j] = static_cast<uint32_t>(y);
+            c[2][j] = purpose;
+            c[3][j] = 0;
+        }
+
+        philox(c);
+
+        //word k of counter j is the tile i + 4 * j + k - skip
+        for (size_t j = 0; j < lanes; ++j) {
+            for (size_t k = 0; k < 4; ++k) {
+                auto const t = i + 4 * j + k;
+                if (t >= skip && t - skip < n) {
+                    out[t - skip] = c[k][j];
+                }
+            }
+        }
+    }
 }
 
 //template <typename Random>
@@ -0,0 +1,351 @@
+////////////////////////////////////////////////////////////////////////////////
+//! @file
+//! Small, fast random engines with independent streams; see random_t.
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+
+#include <boost/predef.h>
+
+#if BOOST_COMP_MSVC
+#   include <intrin.h>
+#endif
+
+namespace yama {
+
+namespace detail {
+
+inline uint64_t rotl64(uint64_t const x, int const k) {
+    return (x << k) | (x >> ((64 - k) & 63));
+}
+
+inline uint64_t rotr64(uint64_t const x, int const k) {
+    return (x >> k) | (x << ((64 - k) & 63));
+}
+
+//! the next value of the splitmix64 sequence at @p state; used for seeding.
+inline uint64_t splitmix64(uint64_t& state) {
+    auto z = (state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Unsigned 128 bit arithmetic modulo 2^128; just what pcg64 needs.
+////////////////////////////////////////////////////////////////////////////////
+struct uint128_t {
+    uint64_t hi;
+    uint64_t lo;
+
+    friend bool operator==(uint128_t const a, uint128_t const b) {
+        return a.hi == b.hi && a.lo == b.lo;
+    }
+
+    friend uint128_t operator+(uint128_t const a, uint128_t const b) {
+        auto const lo = a.lo + b.lo;
+        return uint128_t {a.hi + b.hi + (lo < a.lo ? 1u : 0u), lo};
+    }
+
+    friend uint128_t operator*(uint128_t const a, uint128_t const b) {
+    #if defined(__SIZEOF_INT128__)
+        auto const p = static_cast<unsigned __int128>(a.lo) * b.lo;
+        auto const hi = static_cast<uint64_t>(p >> 64);
+        auto const lo = static_cast<uint64_t>(p);
+    #elif BOOST_COMP_MSVC
+        uint64_t hi = 0;
+        auto const lo = _umul128(a.lo, b.lo, &hi);
+    #else
+        //schoolbook on 32 bit halves
+        auto const a0 = a.lo & 0xffffffffu, a1 = a.lo >> 32;
+        auto const b0 = b.lo & 0xffffffffu, b1 = b.lo >> 32;
+        auto const p00 = a0 * b0;
+        auto const p01 = a0 * b1;
+        auto const p10 = a1 * b0;
+        auto const mid = (p00 >> 32) + (p01 & 0xffffffffu) + (p10 & 0xffffffffu);
+        auto const hi  = a1 * b1 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+        auto const lo  = (mid << 32) | (p00 & 0xffffffffu);
+    #endif
+        return uint128_t {hi + a.hi * b.lo + a.lo * b.hi, lo};
+    }
+};
+
+} //namespace detail
+
+////////////////////////////////////////////////////////////////////////////////
+//! xoshiro256** by Blackman and Vigna: 32 bytes of state, period 2^256 - 1.
+//!
+//! Meets the UniformRandomBitGenerator requirements and can be seeded like
+//! the std engines.
+////////////////////////////////////////////////////////////////////////////////
+class xoshiro256ss {
+public:
+    using result_type = uint64_t;
+    using state_t     = std::array<uint64_t, 4>;
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    xoshiro256ss() : xoshiro256ss {default_seed} {}
+
+    explicit xoshiro256ss(uint64_t const seed) {
+        this->seed(seed);
+    }
+
+    //! restore a state from state(); it must not be all zero.
+    explicit xoshiro256ss(state_t const& state)
+      : s_ (state)
+    {
+    }
+
+    //! the state expanded from @p value by splitmix64, as recommended.
+    void seed(uint64_t value = default_seed) {
+        for (auto& s : s_) {
+            s = detail::splitmix64(value);
+        }
+    }
+
+    result_type operator()() {
+        auto const result = detail::rotl64(s_[1] * 5, 7) * 9;
+        auto const t = s_[1] << 17;
+
+        s_[2] ^= s_[0];
+        s_[3] ^= s_[1];
+        s_[1] ^= s_[2];
+        s_[0] ^= s_[3];
+        s_[2] ^= t;
+        s_[3] = detail::rotl64(s_[3], 45);
+
+        return result;
+    }
+
+    void discard(unsigned long long n) {
+        for (; n > 0; --n) {
+            (*this)();
+        }
+    }
+
+    //! advance by 2^128 values; the values skipped form a stream that doesn't
+    //! overlap the one that follows, for up to 2^128 jumps.
+    void jump() {
+        static uint64_t const polynomial[] = {
+            0x180ec6d33cfd0abaull, 0xd5a61266f0c9392cull
+          , 0xa9582618e03fc9aaull, 0x39abdc4529b1661cull
+        };
+
+        state_t s {};
+        for (auto const word : polynomial) {
+            for (int b = 0; b < 64; ++b) {
+                if (word & (uint64_t {1} << b)) {
+                    for (size_t i = 0; i < s.size(); ++i) {
+                        s[i] ^= s_[i];
+                    }
+                }
+                (*this)();
+            }
+        }
+
+        s_ = s;
+    }
+
+    //! an engine for the stream @p stream_id seeded from the current state;
+    //! this engine is left unchanged.
+    xoshiro256ss split(uint64_t const stream_id) const {
+        auto value = s_[0] ^ detail::rotl64(s_[1], 16) ^ detail::rotl64(s_[2], 32)
+                   ^ detail::rotl64(s_[3], 48);
+        auto mixed = stream_id;
+        return xoshiro256ss {value ^ detail::splitmix64(mixed)};
+    }
+
+    state_t const& state() const {
+        return s_;
+    }
+
+    friend bool operator==(xoshiro256ss const& a, xoshiro256ss const& b) {
+        return a.s_ == b.s_;
+    }
+
+    friend bool operator!=(xoshiro256ss const& a, xoshiro256ss const& b) {
+        return !(a == b);
+    }
+
+    static uint64_t const default_seed = 5489u;
+private:
+    state_t s_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! PCG64 (XSL RR 128/64) by O'Neill: a 128 bit LCG with a permuted 64 bit
+//! output; 32 bytes of state, period 2^128 for each of 2^127 streams.
+//!
+//! Meets the UniformRandomBitGenerator requirements and can be seeded like
+//! the std engines.
+////////////////////////////////////////////////////////////////////////////////
+class pcg64 {
+public:
+    using result_type = uint64_t;
+    using state_t     = std::array<uint64_t, 4>; //!< {state hi, lo, increment hi, lo}
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    pcg64() : pcg64 {default_seed} {}
+
+    explicit pcg64(uint64_t const seed, uint64_t const stream_id = default_stream) {
+        this->seed(seed, stream_id);
+    }
+
+    //! restore a state from state(); the increment must be odd.
+    explicit pcg64(state_t const& state)
+      : state_ {state[0], state[1]}
+      , inc_   {state[2], state[3] | 1u}
+    {
+    }
+
+    void seed(uint64_t const value = default_seed, uint64_t const stream_id = default_stream) {
+        inc_   = detail::uint128_t {stream_id >> 63, (stream_id << 1) | 1u};
+        state_ = detail::uint128_t {0, 0};
+        step_();
+        state_ = state_ + detail::uint128_t {0, value};
+        step_();
+    }
+
+    result_type operator()() {
+        step_();
+        auto const rot = static_cast<int>(state_.hi >> 58);
+        return detail::rotr64(state_.hi ^ state_.lo, rot);
+    }
+
+    void discard(unsigned long long const n) {
+        advance_(detail::uint128_t {0, n});
+    }
+
+    //! advance by 2^64 values in 128 steps of the LCG.
+    void jump() {
+        advance_(detail::uint128_t {1, 0});
+    }
+
+    //! an engine for the stream @p stream_id seeded from the current state;
+    //! engines of different streams never share a sequence. This engine is
+    //! left unchanged.
+    pcg64 split(uint64_t const stream_id) const {
+        return pcg64 {state_.hi ^ detail::rotl64(state_.lo, 32), stream_id};
+    }
+
+    state_t state() const {
+        return state_t {{state_.hi, state_.lo, inc_.hi, inc_.lo}};
+    }
+
+    friend bool operator==(pcg64 const& a, pcg64 const& b) {
+        return a.state_ == b.state_ && a.inc_ == b.inc_;
+    }
+
+    friend bool operator!=(pcg64 const& a, pcg64 const& b) {
+        return !(a == b);
+    }
+
+    static uint64_t const default_seed   = 5489u;
+    static uint64_t const default_stream = 0xda3e39cb94b95bdbull;
+private:
+    static detail::uint128_t multiplier() {
+        return detail::uint128_t {2549297995355413924ull, 4865540595714422341ull};
+    }
+
+    void step_() {
+        state_ = state_ * multiplier() + inc_;
+    }
+
+    //! advance by @p delta steps in O(log delta) (Brown, "Random number
+    //! generation with arbitrary strides").
+    void advance_(detail::uint128_t delta) {
+        detail::uint128_t acc_mult {0, 1};
+        detail::uint128_t acc_plus {0, 0};
+        detail::uint128_t cur_mult = multiplier();
+        detail::uint128_t cur_plus = inc_;
+
+        while (delta.hi || delta.lo) {
+            if (delta.lo & 1u) {
+                acc_mult = acc_mult * cur_mult;
+                acc_plus = acc_plus * cur_mult + cur_plus;
+            }
+
+            cur_plus = (cur_mult + detail::uint128_t {0, 1}) * cur_plus;
+            cur_mult = cur_mult * cur_mult;
+
+            delta.lo = (delta.lo >> 1) | (delta.hi << 63);
+            delta.hi >>= 1;
+        }
+
+        state_ = acc_mult * state_ + acc_plus;
+    }
+
+    detail::uint128_t state_;
+    detail::uint128_t inc_;
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! Philox-4x32-10 by Salmon et al. (Random123): a keyed bijection of 128 bit
+//! counters; the basis of hash_random.
+////////////////////////////////////////////////////////////////////////////////
+struct philox4x32 {
+    using counter_t = std::array<uint32_t, 4>;
+    using key_t     = std::array<uint32_t, 2>;
+
+    static int const rounds = 10;
+
+    //! the key of every round.
+    explicit philox4x32(key_t const key) {
+        for (int r = 0; r < rounds; ++r) {
+            keys[r][0] = key[0] + static_cast<uint32_t>(r) * 0x9e3779b9u;
+            keys[r][1] = key[1] + static_cast<uint32_t>(r) * 0xbb67ae85u;
+        }
+    }
+
+    counter_t operator()(counter_t c) const {
+        for (int r = 0; r < rounds; ++r) {
+            auto const p0 = uint64_t {0xd2511f53u} * c[0];
+            auto const p1 = uint64_t {0xcd9e8d57u} * c[2];
+
+            c = counter_t {{
+                static_cast<uint32_t>(p1 >> 32) ^ c[1] ^ keys[r][0]
+              , static_cast<uint32_t>(p1)
+              , static_cast<uint32_t>(p0 >> 32) ^ c[3] ^ keys[r][1]
+              , static_cast<uint32_t>(p0)
+            }};
+        }
+
+        return c;
+    }
+
+    ////////////////////////////////////////////////////////////////////////////
+    //! @p N counters at once, word i of counter j in c[i][j]; the same as N
+    //! single calls, in a form compilers vectorize.
+    ////////////////////////////////////////////////////////////////////////////
+    template <size_t N>
+    void operator()(uint32_t (&c)[4][N]) const {
+        for (int r = 0; r < rounds; ++r) {
+            auto const k0 = keys[r][0];
+            auto const k1 = keys[r][1];
+
+            for (size_t j = 0; j < N; ++j) {
+                auto const p0 = uint64_t {0xd2511f53u} * c[0][j];
+                auto const p1 = uint64_t {0xcd9e8d57u} * c[2][j];
+
+                auto const c1 = c[1][j];
+                auto const c3 = c[3][j];
+
+                c[0][j] = static_cast<uint32_t>(p1 >> 32) ^ c1 ^ k0;
+                c[1][j] = static_cast<uint32_t>(p1);
+                c[2][j] = static_cast<uint32_t>(p0 >> 32) ^ c3 ^ k1;
+                c[3][j] = static_cast<uint32_t>(p0);
+            }
+        }
+    }
+
+    uint32_t keys[rounds][2];
+};
+
+} //namespace yama
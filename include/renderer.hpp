@@ -18,6 +18,11 @@ public:
         float x0, y0, x1, y1;
     };
 
+    //! A rect in pixels; as taken by fill_rect.
+    struct int_rect {
+        int x, y, w, h;
+    };
+
     explicit renderer(window_handle window);
     ~renderer();
 
@@ -37,6 +42,12 @@ public:
     void fill_rect(int x, int y, int w, int h);
     void draw_rect(int x, int y, int w, int h);
 
+    //! fill_rect for each of the @p n rects at @p rects, in a single draw call.
+    void fill_rects(int_rect const* rects, size_t n);
+
+    //! draw_rect for each of the @p n rects at @p rects, in a single draw call.
+    void draw_rects(int_rect const* rects, size_t n);
+
     void clear();
 
     void present();
@@ -12,4 +12,7 @@ enum class tile_category : uint16_t {
   , invalid
 };
 
+using room_id_t    = uint16_t; //!< Identifies the room (region) a tile belongs to.
+using texture_id_t = uint16_t; //!< Identifies the texture used to draw a tile.
+
 } //namespace yama
@@ -3,8 +3,10 @@
 #include <cstdint>
 #include <string>
 #include <random>
+#include <type_traits>
 
 #include "math.hpp"
+#include "random_engine.hpp"
 
 namespace yama {
 
@@ -20,7 +22,21 @@ using std::int64_t;
 
 using utf8str = std::string;
 
+//the engine used for generation; levels differ between engines.
+#if defined(YAMA_RANDOM_XOSHIRO256)
+using random_t = xoshiro256ss;
+#elif defined(YAMA_RANDOM_PCG64)
+using random_t = pcg64;
+#else
 using random_t = std::mt19937;
+#endif
+
+//! which engine random_t is; saved with anything that depends on its values.
+inline uint32_t random_engine_id() {
+    return std::is_same<random_t, xoshiro256ss>::value ? 1u
+         : std::is_same<random_t, pcg64>::value        ? 2u
+         : 0u;
+}
 
 using rect_t          = yama::axis_aligned_rect<int>;
 using point_t         = yama::point2d<int>;
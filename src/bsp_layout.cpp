@@ -1,6 +1,11 @@
 #include "pch.hpp"
 #include "detail/bsp_layout_impl.hpp"
 
+#include <atomic>
+#include <limits>
+#include <numeric>
+#include <thread>
+
 using bsp_layout = yama::bsp_layout;
 using bsp_layout_impl = yama::detail::bsp_layout_impl;
 using random_t = yama::random_t;
@@ -32,14 +37,17 @@ bsp_layout_impl::bsp_layout_impl(params_t const Params)
   : params_ {validate(Params)}
   , nodes_ {}
   , rooms_ {}
-  , map_ (params_.map_w, params_.map_h)
+  , room_nodes_ {}
+  , room_scratch_ {}
+  , route_ {}
+  , subtrees_ {}
 {
 }
 //------------------------------------------------------------------------------
 void bsp_layout_impl::clear() {
     nodes_.clear();
     rooms_.clear();
-    map_.clear();
+    room_nodes_.clear();
 }
 //------------------------------------------------------------------------------
 
@@ -50,20 +58,118 @@ yama::rect_t shrink_rect(yama::rect_t const r) {
 
     return {r.left + 1, r.top + 1, r.right - 1, r.bottom - 1};
 }
+
+//! threads to use for @p n tasks; thread_count is 0 for one per core.
+size_t worker_count(int const thread_count, size_t const n) {
+    return std::min(n, static_cast<size_t>(thread_count > 0
+      ? thread_count
+      : std::max(1, static_cast<int>(std::thread::hardware_concurrency()))));
+}
+
+//! call worker() on @p threads threads, one of them this one.
+template <typename F>
+void run_workers(size_t const threads, F&& worker) {
+    std::vector<std::thread> workers;
+    workers.reserve(threads > 0 ? threads - 1 : 0);
+
+    for (size_t i = 1; i < threads; ++i) {
+        workers.emplace_back([&worker] { worker(); });
+    }
+
+    worker();
+
+    for (auto& w : workers) {
+        w.join();
+    }
+}
 }
 
 yama::map bsp_layout_impl::generate(random_t& random) {
+    map result {params_.map_w, params_.map_h};
+    generate_into(result, random);
+    return result;
+}
+//------------------------------------------------------------------------------
+void bsp_layout_impl::generate_into(map& out, random_t& random) {
+    using clock = phase_times_t::clock;
+
+    auto last = phase_times_ ? clock::now() : clock::time_point {};
+
+    //charge the time since the last lap to phase
+    auto const lap = [&](phase_times_t::duration phase_times_t::* const phase) {
+        if (!phase_times_) {
+            return;
+        }
+
+        auto const now = clock::now();
+        phase_times_->*phase = now - last;
+        last = now;
+    };
+
+    //only a map of another size (or a read only one) needs new storage
+    if (out.width() != params_.map_w || out.height() != params_.map_h || out.is_read_only()) {
+        out = map {params_.map_w, params_.map_h};
+    } else {
+        out.clear();
+    }
+
+    map_ = &out;
+
+    //sized for the worst case once, so that no seed reallocates: no room is
+    //larger than the map, and no leaf smaller than the minimum region.
+    auto const max_w = static_cast<size_t>(params_.map_w);
+    auto const max_h = static_cast<size_t>(params_.map_h);
+    room_scratch_.ring.reserve(2 * (max_w + 2) + 2 * (max_h + 2));
+    room_scratch_.strip.reserve(max_w + 2);
+    room_scratch_.tiles.reserve(max_w * max_h);
+
+    auto const min_area = static_cast<size_t>(std::max(1, static_cast<int>(params_.region_w_range.lower)))
+                        * static_cast<size_t>(std::max(1, static_cast<int>(params_.region_h_range.lower)));
+    auto const max_leaves = max_w * max_h / min_area + 1;
+    nodes_.reserve(2 * max_leaves);
+    room_nodes_.reserve(max_leaves);
+    rooms_.reserve(max_leaves);
+
     clear();
     nodes_.push_back(node {rect_t {0, 0, params_.map_w, params_.map_h}});
+    lap(&phase_times_t::clear);
+
+    if (params_.subtree_area > 0) {
+        //subtrees are split, filled and connected on their own threads; all of
+        //that is charged to rooms.
+        generate_subtrees(random);
+        lap(&phase_times_t::rooms);
+
+        connect(random, nodes_[0]);
+        splice_subtrees();
+        lap(&phase_times_t::connect);
+    } else {
+        generate_tree(random);
+        lap(&phase_times_t::tree);
+
+        generate_rooms(random);
+        lap(&phase_times_t::rooms);
+
+        for (auto const& room : rooms_) {
+            write_room(room);
+        }
+        lap(&phase_times_t::write_rooms);
 
-    generate_tree(random);
-    generate_rooms(random);
-
-    for (auto const& room : rooms_) {
-        write_room(room);
+        connect(random, nodes_[0]);
+        lap(&phase_times_t::connect);
     }
 
-    connect(random, nodes_[0]);
+    place_stairs(random, nullptr);
+    lap(&phase_times_t::stairs);
+
+    map_ = nullptr;
+}
+//------------------------------------------------------------------------------
+int bsp_layout_impl::place_stairs(random_t& random, grid_position_t* const out) {
+    //no room was generated; there is nowhere to put stairs
+    if (rooms_.empty()) {
+        return 0;
+    }
 
     auto const first_room = shrink_rect(rooms_.front());
     auto const last_room  = shrink_rect(rooms_.back());
@@ -71,13 +177,15 @@ yama::map bsp_layout_impl::generate(random_t& random) {
     auto const p0 = generate::bounded_point(random, first_room);
     auto const p1 = generate::bounded_point(random, last_room);
 
-    map_.set<map_property::category>(p0, tile_category::stair);
-    map_.set<map_property::category>(p1, tile_category::stair);
+    map_->set<map_property::category>(p0, tile_category::stair);
+    map_->set<map_property::category>(p1, tile_category::stair);
 
-    auto result = std::move(map_);
-    map_ = map {params_.map_w, params_.map_h};
+    if (out) {
+        out[0] = p0;
+        out[1] = p1;
+    }
 
-    return result;
+    return 2;
 }
 //------------------------------------------------------------------------------
 void bsp_layout_impl::generate_tree(random_t& random) {
@@ -89,6 +197,180 @@ void bsp_layout_impl::generate_tree(random_t& random) {
     }
 }
 //------------------------------------------------------------------------------
+void bsp_layout_impl::generate_subtrees(random_t& random) {
+    BK_ASSERT(nodes_.size() == 1);
+
+    auto const max_area = static_cast<int>(params_.subtree_area);
+
+    //too narrow for a map of its own; split and filled on this thread
+    auto const is_thin = [](rect_t const r) {
+        return r.width() < map_min_size || r.height() < map_min_size;
+    };
+
+    subtrees_.clear();
+
+    std::vector<node::index_t> thin_leaves;
+
+    //the top tree; each iteration can increase size()
+    for (size_t i = 0; i < nodes_.size(); ++i) {
+        auto const bounds = nodes_[i].bounds;
+
+        if (bounds.area() > max_area || is_thin(bounds)) {
+            split_node(random, nodes_[i]);
+        }
+
+        if (!nodes_[i].is_leaf()) {
+            continue;
+        } else if (is_thin(bounds)) {
+            thin_leaves.push_back(static_cast<node::index_t>(i));
+        } else {
+            subtrees_.push_back(subtree_t {static_cast<node::index_t>(i), 0, {}, {}, 0, {}, {}});
+        }
+    }
+
+    //drawn up front so no stream depends on the order subtrees are generated
+    for (auto& s : subtrees_) {
+        s.seed = static_cast<uint32_t>(random());
+    }
+
+    auto const n       = subtrees_.size();
+    auto const threads = worker_count(thread_count_, n);
+
+    std::atomic<size_t> next {0};
+
+    auto const worker = [&] {
+        auto p = params_;
+        p.subtree_area = 0;
+
+        bsp_layout_impl sub {p};
+
+        for (auto i = next++; i < n; i = next++) {
+            auto& s = subtrees_[i];
+            auto const bounds = nodes_[s.leaf].bounds;
+
+            p.map_w = bounds.width();
+            p.map_h = bounds.height();
+            sub.set_params(p);
+
+            map local {p.map_w, p.map_h};
+            random_t sub_random {s.seed};
+
+            sub.map_ = &local;
+            sub.clear();
+            sub.nodes_.push_back(node {rect_t {0, 0, p.map_w, p.map_h}});
+
+            sub.generate_tree(sub_random);
+            sub.generate_rooms(sub_random);
+
+            for (auto const& room : sub.rooms_) {
+                sub.write_room(room);
+            }
+
+            auto const connected = sub.connect(sub_random, sub.nodes_[0]);
+            sub.map_ = nullptr;
+
+            auto const to_map = [&](rect_t const r) {
+                return rect_t {r.left + bounds.left, r.top + bounds.top, r.right + bounds.left, r.bottom + bounds.top};
+            };
+
+            s.nodes.assign(sub.nodes_.begin(), sub.nodes_.end());
+            for (auto& nd : s.nodes) {
+                nd.bounds = to_map(nd.bounds);
+            }
+
+            s.rooms.resize(sub.rooms_.size());
+            std::transform(sub.rooms_.begin(), sub.rooms_.end(), s.rooms.begin(), to_map);
+
+            s.connected = {connected.first, to_map(connected.second)};
+
+            s.tiles.resize(static_cast<size_t>(bounds.area()));
+            local.read_rect<map_property::category>(rect_t {0, 0, p.map_w, p.map_h}, s.tiles.data());
+        }
+    };
+
+    run_workers(threads, worker);
+
+    write_subtrees();
+
+    //the top tree is connected through one room of each subtree
+    for (auto& s : subtrees_) {
+        s.room_offset = rooms_.size();
+        rooms_.insert(rooms_.end(), s.rooms.begin(), s.rooms.end());
+
+        if (s.connected.first) {
+            auto const it = std::find(s.rooms.begin(), s.rooms.end(), s.connected.second);
+            BK_ASSERT(it != s.rooms.end());
+
+            nodes_[s.leaf].set_data(static_cast<node::index_t>(s.room_offset) + static_cast<node::index_t>(it - s.rooms.begin()));
+        }
+    }
+
+    //thin leaves, as generate_rooms would
+    for (auto const i : thin_leaves) {
+        auto& leaf = nodes_[i];
+
+        if (!do_generate_room(random, leaf.bounds)) {
+            continue;
+        }
+
+        auto const room = generate_room(random, leaf.bounds);
+
+        rooms_.emplace_back(room);
+        leaf.set_data(static_cast<node::index_t>(rooms_.size() - 1));
+
+        write_room(room);
+    }
+}
+//------------------------------------------------------------------------------
+void bsp_layout_impl::write_subtrees() {
+    //the workers only fill their own tiles; the map (and any journal) is only
+    //written to from this thread, in subtree order.
+    for (auto const& s : subtrees_) {
+        auto const r = nodes_[s.leaf].bounds;
+        map_->write_rect<map_property::category>(r, s.tiles.data());
+    }
+
+    for (auto& s : subtrees_) {
+        std::vector<tile_category>().swap(s.tiles);
+    }
+}
+//------------------------------------------------------------------------------
+void bsp_layout_impl::splice_subtrees() {
+    auto const count = std::accumulate(subtrees_.begin(), subtrees_.end(), nodes_.size()
+      , [](size_t const sum, subtree_t const& s) { return sum + s.nodes.size() - 1; });
+
+    nodes_.reserve(count);
+
+    for (auto const& s : subtrees_) {
+        auto const& root = s.nodes.front();
+
+        //a single leaf; the top leaf already refers to its room
+        if (root.is_leaf()) {
+            continue;
+        }
+
+        //s.nodes[j] becomes nodes_[offset + j]; the root is the top leaf
+        auto const offset = static_cast<node::index_t>(nodes_.size()) - 1;
+
+        for (size_t j = 1; j < s.nodes.size(); ++j) {
+            auto nd = s.nodes[j];
+
+            if (!nd.is_leaf()) {
+                nd.first  += offset;
+                nd.second += offset;
+            } else if (!nd.is_empty()) {
+                nd.second += static_cast<node::index_t>(s.room_offset);
+            }
+
+            nodes_.push_back(nd);
+        }
+
+        auto& leaf = nodes_[s.leaf];
+        leaf.first  = root.first  + offset;
+        leaf.second = root.second + offset;
+    }
+}
+//------------------------------------------------------------------------------
 void bsp_layout_impl::split_node(random_t& random, node& n) {
     BK_ASSERT(n.is_empty());
 
@@ -119,7 +401,7 @@ void bsp_layout_impl::split_node(random_t& random, node& n) {
 void bsp_layout_impl::generate_rooms(random_t& random) {
     BK_ASSERT(rooms_.empty());
 
-    std::vector<node*> nodes;
+    auto& nodes = room_nodes_;
 
     for (auto& n : nodes_) {
         //internal node => next
@@ -194,64 +476,103 @@ yama::rect_t bsp_layout_impl::generate_room(random_t& random, yama::rect_t bound
 }
 //------------------------------------------------------------------------------
 void bsp_layout_impl::write_room(yama::rect_t const room) {
+    BK_ASSERT(room.width() >= 1 && room.height() >= 1);
+
     auto const map_bounds = rect_t {0, 0, params_.map_w, params_.map_h};
+    auto const categories = map_->view<map::property::category>();
 
-    auto const is_wall_or_door = [&](grid_position_t const p) {
-        if (!map_bounds.contains(p)) {
-            return false;
-        }
+    auto const w = room.width();
+    auto const h = room.height();
 
-        auto const value = map_.get<map::property::category>(p);
-        return value == tile_category::wall || value == tile_category::door;
-    };
+    //whether each tile of the ring around the room is a wall or door; the
+    //room's own tiles are never read, so the order they're written in doesn't
+    //matter.
+    auto& ring = room_scratch_.ring;
+    ring.resize(2 * static_cast<size_t>(w + 2) + 2 * static_cast<size_t>(h + 2));
 
-    auto const check = [&](std::tuple<grid_position_t, grid_position_t, grid_position_t> const t) {
-        return is_wall_or_door(std::get<0>(t))
-            && is_wall_or_door(std::get<1>(t))
-            && is_wall_or_door(std::get<2>(t));
-    };
+    auto const above = ring.data();      //(left - 1 + i, top - 1)
+    auto const below = above + (w + 2);  //(left - 1 + i, bottom)
+    auto const left  = below + (w + 2);  //(left - 1, top - 1 + i)
+    auto const right = left  + (h + 2);  //(right, top - 1 + i)
 
-    auto const omit_left = [&](grid_position_t const p) {
-        return check(get_ahead<direction::nw, direction::w, direction::sw>(p));
+    auto const is_wall_or_door = [](tile_category const value) -> uint8_t {
+        return (value == tile_category::wall || value == tile_category::door) ? 1 : 0;
     };
 
-    auto const omit_top = [&](grid_position_t const p) {
-        return check(get_ahead<direction::nw, direction::n, direction::ne>(p));
+    std::fill(ring.begin(), ring.end(), uint8_t {0});
+
+    //rows above and below, clipped to the map; tiles off the map are 0
+    auto& strip = room_scratch_.strip;
+    strip.resize(static_cast<size_t>(w + 2));
+
+    auto const x0 = std::max(room.left - 1, map_bounds.left);
+    auto const x1 = std::min(room.right + 1, map_bounds.right);
+
+    auto const read_strip = [&](int const y, uint8_t* const out) {
+        if (y < map_bounds.top || y >= map_bounds.bottom) {
+            return;
+        }
+
+        categories.read_row(y, x0, x1, strip.data());
+        std::transform(strip.data(), strip.data() + (x1 - x0), out + (x0 - (room.left - 1)), is_wall_or_door);
     };
 
-    auto const omit_right = [&](grid_position_t const p) {
-        return check(get_ahead<direction::ne, direction::e, direction::se>(p));
+    read_strip(room.top - 1, above);
+    read_strip(room.bottom,  below);
+
+    //columns to the left and right; the corners were read with the rows
+    for (int i = 1; i < h + 1; ++i) {
+        auto const y = room.top - 1 + i;
+
+        left[i]  = room.left > map_bounds.left   ? is_wall_or_door(categories(room.left - 1, y)) : 0;
+        right[i] = room.right < map_bounds.right ? is_wall_or_door(categories(room.right, y))    : 0;
+    }
+
+    left[0]      = above[0];
+    right[0]     = above[w + 1];
+    left[h + 1]  = below[0];
+    right[h + 1] = below[w + 1];
+
+    //a border tile is omitted (left as floor) if the three tiles beyond it
+    //are walls or doors; side[i] is tile i - 1 of the side.
+    auto const omit = [](uint8_t const* const side, int const i) {
+        return (side[i] & side[i + 1] & side[i + 2]) != 0;
     };
 
-    auto const omit_bottom = [&](grid_position_t const p) {
-        return check(get_ahead<direction::sw, direction::s, direction::se>(p));
+    auto const wall = [](bool const omitted) {
+        return omitted ? tile_category::floor : tile_category::wall;
     };
 
-    yama::for_each_xy(room, [&](grid_position_t const p) {
-        auto const is_border = room.is_border(p);
+    //the interior, then the left and right walls of every row, then the top
+    //and bottom walls; corners need every side they belong to omitted.
+    auto& tiles = room_scratch_.tiles;
+    tiles.assign(static_cast<size_t>(w) * static_cast<size_t>(h), tile_category::floor);
 
-        auto const is_l = room.is_left(p);
-        auto const is_t = room.is_top(p);
-        auto const is_r = room.is_right(p);
-        auto const is_b = room.is_bottom(p);
+    for (int y = 0; y < h; ++y) {
+        auto const row = tiles.data() + static_cast<size_t>(y) * static_cast<size_t>(w);
+        auto const l   = omit(left, y);
+        auto const r   = omit(right, y);
 
-        BK_ASSERT(!(is_l && is_r));
-        BK_ASSERT(!(is_t && is_b));
+        auto const t = y == 0;
+        auto const b = y == h - 1;
 
-        auto const omit_wall =
-            (is_l ? omit_left(p)   : true)
-         && (is_t ? omit_top(p)    : true)
-         && (is_r ? omit_right(p)  : true)
-         && (is_b ? omit_bottom(p) : true);
+        row[0]     = wall(l && (!t || omit(above, 0))     && (!b || omit(below, 0)));
+        row[w - 1] = wall(r && (!t || omit(above, w - 1)) && (!b || omit(below, w - 1)));
 
-        auto const value = is_border
-          ? omit_wall
-              ? tile_category::floor
-              : tile_category::wall
-          : tile_category::floor;
+        if (w == 1) {
+            row[0] = wall(l && r && (!t || omit(above, 0)) && (!b || omit(below, 0)));
+        }
+    }
 
-        map_.set<map::property::category>(p.x, p.y, value);
-    });
+    auto const top_row    = tiles.data();
+    auto const bottom_row = tiles.data() + static_cast<size_t>(h - 1) * static_cast<size_t>(w);
+
+    for (int x = 1; x < w - 1; ++x) {
+        top_row[x]    = wall(omit(above, x));
+        bottom_row[x] = wall(omit(below, x) && (h > 1 || omit(above, x)));
+    }
+
+    map_->write_rect<map::property::category>(room, tiles.data());
 }
 //------------------------------------------------------------------------------
 void bsp_layout_impl::do_connect(
@@ -260,6 +581,11 @@ void bsp_layout_impl::do_connect(
   , yama::rect_t const first
   , yama::rect_t const second
 ) {
+    //without a route, fall back to the random walk so the rooms still connect
+    if (params_.route_corridors && route_corridor(random, bounds, first, second)) {
+        return;
+    }
+
     auto       p   = first.center();
     auto const beg = p;
     auto const end = second.center();
@@ -300,7 +626,6 @@ void bsp_layout_impl::do_connect(
         count++;
 
         if (count == 100) {
-            std::cout << "warning!" << std::endl;
             break;
         } else if (count % 20 == 0) {
             p = beg;
@@ -308,25 +633,62 @@ void bsp_layout_impl::do_connect(
     }
 }
 //------------------------------------------------------------------------------
-bsp_layout_impl::possible
-bsp_layout_impl::can_tunnel(
-    yama::point_t const left
-  , yama::point_t const ahead
-  , yama::point_t const right
-) const {
-    auto const is_wall = [&](point_t const p) {
-        constexpr auto cat = map::property::category;
-        return map_.get<cat>(p.x, p.y) == tile_category::wall;
+namespace {
+
+//! the cost of tunneling into a tile; existing corridors are preferred and
+//! new doors avoided.
+uint32_t tunnel_cost(yama::tile_category const value) {
+    using cat = yama::tile_category;
+
+    switch (value) {
+    case cat::corridor: return 6;
+    case cat::empty:    return 12;
+    case cat::wall:     return 32;
+    default:            return 8;
+    }
+}
+
+//! the estimated cost per tile to the target for route_corridor.
+uint32_t const estimate_cost = 16;
+
+//! uniform noise in [0, 256) for a tile; a hash keeps it independent of the
+//! order tiles are visited in.
+uint32_t tile_noise(uint32_t const seed, int const x, int const y) {
+    auto h = seed ^ (static_cast<uint32_t>(x) * 0x9E3779B1u) ^ (static_cast<uint32_t>(y) * 0x85EBCA77u);
+    h ^= h >> 16;
+    h *= 0x7FEB352Du;
+    h ^= h >> 15;
+    h *= 0x846CA68Bu;
+    h ^= h >> 16;
+    return h >> 24;
+}
+
+//                      n   e   s   w
+int const step_x[] = { 0,  1,  0, -1};
+int const step_y[] = {-1,  0,  1,  0};
+
+using category_view = yama::map::view_t<yama::map_property::category>;
+using possible      = bsp_layout_impl::possible;
+
+//! see bsp_layout_impl::can_tunnel.
+possible can_tunnel_in(
+    category_view const& categories
+  , yama::point_t const  left
+  , yama::point_t const  ahead
+  , yama::point_t const  right
+) {
+    auto const is_wall = [&](yama::point_t const p) {
+        return categories(p.x, p.y) == yama::tile_category::wall;
     };
 
-    if (!map_.is_valid_position(ahead)) {
+    if (!categories.is_valid_index(ahead.x, ahead.y)) {
         return possible::no;
     } else if (!is_wall(ahead)) {
         return possible::yes;
     }
 
-    auto const ok_left  = map_.is_valid_position(left.x,  left.y);
-    auto const ok_right = map_.is_valid_position(right.x, right.y);
+    auto const ok_left  = categories.is_valid_index(left.x,  left.y);
+    auto const ok_right = categories.is_valid_index(right.x, right.y);
 
     if (!(ok_left && ok_right)) {
         return possible::no;
@@ -338,6 +700,154 @@ bsp_layout_impl::can_tunnel(
 
     return possible::no;
 }
+
+//! whether a tunnel may step from @p p by (dx, dy); the same rule as
+//! make_connection_tunnel.
+bool can_step(category_view const& categories, yama::point_t const p, int const dx, int const dy) {
+    //ahead of q by (dx, dy), and the tiles to either side of it
+    auto const check = [&](yama::point_t const q) {
+        yama::point_t const ahead {q.x + dx, q.y + dy};
+        return can_tunnel_in(categories
+          , yama::point_t {ahead.x + dy, ahead.y + dx}
+          , ahead
+          , yama::point_t {ahead.x - dy, ahead.y - dx});
+    };
+
+    auto const result = check(p);
+
+    if (result == possible::maybe) {
+        return check(yama::point_t {p.x + dx, p.y + dy}) != possible::no;
+    }
+
+    return (result == possible::yes);
+}
+
+} //namespace
+
+bool bsp_layout_impl::route_corridor(
+    random_t&          random
+  , yama::rect_t const bounds
+  , yama::rect_t const first
+  , yama::rect_t const second
+) {
+    auto const w = bounds.width();
+    auto const n = static_cast<size_t>(bounds.area());
+
+    auto& tiles = route_.tiles;
+    auto& open  = route_.open;
+
+    //entries are stamped by search, so a smaller bounds reuses the scratch as
+    //is whatever the layout of the searches before it.
+    if (tiles.size() < n || ++route_.search == 0) {
+        tiles.assign(std::max(n, tiles.size()), route_scratch_t::tile_t {});
+        route_.search = 1;
+    }
+
+    auto const search = route_.search;
+    open.clear();
+
+    auto const noise_seed  = static_cast<uint32_t>(random());
+    auto const noise_scale = static_cast<uint32_t>(std::round(params_.corridor_randomness * 256.0f));
+
+    auto const index_of = [w, bounds](point_t const p) {
+        return static_cast<uint32_t>((p.x - bounds.left) + (p.y - bounds.top) * w);
+    };
+
+    auto const point_of = [w, bounds](uint32_t const i) {
+        return point_t {bounds.left + static_cast<int>(i) % w, bounds.top + static_cast<int>(i) / w};
+    };
+
+    //deliberately more than the cost of empty tiles: the search heads for
+    //second rather than proving the path is the cheapest, which would expand
+    //most of bounds; ~7x fewer expansions on 256x256 maps.
+    auto const estimate = [&](point_t const p) {
+        auto const dx = std::max({second.left - p.x, 0, p.x - (second.right - 1)});
+        auto const dy = std::max({second.top  - p.y, 0, p.y - (second.bottom - 1)});
+        return static_cast<uint32_t>(dx + dy) * estimate_cost;
+    };
+
+    auto const categories = map_->view<map::property::category>();
+
+    auto const step_cost = [&](point_t const p) {
+        auto const base = tunnel_cost(categories(p.x, p.y));
+        return base + ((base * noise_scale * tile_noise(noise_seed, p.x, p.y)) >> 16);
+    };
+
+    using entry = std::pair<uint32_t, uint32_t>;
+    auto const later = std::greater<entry> {};
+
+    auto const start = first.center();
+    BK_ASSERT(bounds.contains(start));
+
+    tiles[index_of(start)] = route_scratch_t::tile_t {search, 0, 0, 0};
+    open.push_back(entry {estimate(start), index_of(start)});
+
+    //A* without reopening: every tile of bounds is expanded at most once and
+    //pushed at most 4 times, so the time is bounded by the area of bounds.
+    while (!open.empty()) {
+        std::pop_heap(open.begin(), open.end(), later);
+        auto const e = open.back();
+        open.pop_back();
+
+        auto const i = e.second;
+        auto const p = point_of(i);
+        auto const g = tiles[i].cost;
+
+        //a stale entry for a tile since reached more cheaply
+        if (tiles[i].closed == search || e.first != g + estimate(p)) {
+            continue;
+        }
+
+        tiles[i].closed = search;
+
+        if (!second.contains(p)) {
+            for (uint32_t d = 0; d < 4; ++d) {
+                point_t const q {p.x + step_x[d], p.y + step_y[d]};
+
+                if (!bounds.contains(q) || !can_step(categories, p, step_x[d], step_y[d])) {
+                    continue;
+                }
+
+                auto& t = tiles[index_of(q)];
+                if (t.closed == search) {
+                    continue;
+                }
+
+                auto const c = g + step_cost(q);
+
+                if (t.search != search || c < t.cost) {
+                    t = route_scratch_t::tile_t {search, t.closed, c, d};
+                    open.push_back(entry {c + estimate(q), index_of(q)});
+                    std::push_heap(open.begin(), open.end(), later);
+                }
+            }
+
+            continue;
+        }
+
+        //tunnel back along the path
+        for (auto q = p; q != start; ) {
+            map_->set<map::property::category>(q.x, q.y, corridor_transform(categories(q.x, q.y)));
+
+            auto const d = tiles[index_of(q)].from;
+            q.x -= step_x[d];
+            q.y -= step_y[d];
+        }
+
+        return true;
+    }
+
+    return false;
+}
+//------------------------------------------------------------------------------
+bsp_layout_impl::possible
+bsp_layout_impl::can_tunnel(
+    yama::point_t const left
+  , yama::point_t const ahead
+  , yama::point_t const right
+) const {
+    return can_tunnel_in(map_->view<map::property::category>(), left, ahead, right);
+}
 //------------------------------------------------------------------------------
 yama::point_t bsp_layout_impl::make_connection_tunnel(
     yama::point_t p
@@ -404,8 +914,8 @@ yama::point_t bsp_layout_impl::make_connection_tunnel(
         dy -= step_y;
 
         constexpr auto cat = map::property::category;
-        auto const value = map_.get<cat>(p.x, p.y);
-        map_.set<cat>(p.x, p.y, corridor_transform(value));
+        auto const value = map_->get<cat>(p.x, p.y);
+        map_->set<cat>(p.x, p.y, corridor_transform(value));
     }
 
     return p;
@@ -475,10 +985,58 @@ void bsp_layout::set_params(params_t const p) {
     impl_->set_params(p);
 }
 //------------------------------------------------------------------------------
+void bsp_layout::set_thread_count(int const n) {
+    impl_->set_thread_count(n);
+}
+//------------------------------------------------------------------------------
 yama::map yama::bsp_layout::generate(random_t& random) {
     return impl_->generate(random);
 }
 //------------------------------------------------------------------------------
+void yama::bsp_layout::generate_into(map& out, random_t& random) {
+    impl_->generate_into(out, random);
+}
+//------------------------------------------------------------------------------
 std::vector<yama::rect_t> yama::bsp_layout::get_regions() const {
     return impl_->get_regions();
 }
+//------------------------------------------------------------------------------
+std::vector<yama::rect_t> const& yama::bsp_layout::get_rooms() const {
+    return impl_->get_rooms();
+}
+//------------------------------------------------------------------------------
+std::vector<yama::map> yama::generate_batch(
+    std::vector<uint32_t> const& seeds
+  , bsp_layout::params_t  const& params
+  , int                    const thread_count
+) {
+    auto const n = seeds.size();
+
+    auto const threads = worker_count(thread_count, n);
+
+    std::vector<std::unique_ptr<map>> maps (n);
+    std::atomic<size_t> next {0};
+
+    //workers take the next seed as they finish, so uneven levels balance out;
+    //which worker makes a level doesn't matter as each has its own stream.
+    auto const worker = [&] {
+        bsp_layout_impl layout {params};
+        layout.set_thread_count(1);
+
+        for (auto i = next++; i < n; i = next++) {
+            random_t random {seeds[i]};
+            maps[i] = std::make_unique<map>(layout.generate(random));
+        }
+    };
+
+    run_workers(threads, worker);
+
+    std::vector<map> result;
+    result.reserve(n);
+
+    for (auto& m : maps) {
+        result.push_back(std::move(*m));
+    }
+
+    return result;
+}
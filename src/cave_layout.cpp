@@ -0,0 +1,244 @@
+#include "pch.hpp"
+#include "cave_layout.hpp"
+#include "random.hpp"
+
+#include <algorithm>
+#include <vector>
+
+using cave_layout = yama::cave_layout;
+using random_t = yama::random_t;
+
+namespace {
+
+using word_t = uint64_t;
+
+int const  word_bits = 64;
+word_t const all_ones = ~word_t {0};
+
+} //namespace
+
+////////////////////////////////////////////////////////////////////////////////
+//! The grid is h rows of words_ words, bit x % 64 of word x / 64 being the
+//! tile at x. A set bit is a wall; bits past the right edge are always set so
+//! that they read as walls when shifted in.
+////////////////////////////////////////////////////////////////////////////////
+class cave_layout::impl_t {
+public:
+    explicit impl_t(params_t const p)
+      : params_ {p}
+    {
+    }
+
+    params_t params() const {
+        return params_;
+    }
+
+    void set_params(params_t const p) {
+        params_ = p;
+    }
+
+    map generate(random_t& random) {
+        map result {params_.map_w, params_.map_h};
+        generate_into(result, random);
+        return result;
+    }
+
+    void generate_into(map& out, random_t& random);
+private:
+    word_t* row_(std::vector<word_t>& v, int const y) {
+        return v.data() + static_cast<size_t>(y) * words_;
+    }
+
+    //! force the outermost tiles and the bits past the edge to walls.
+    void close_edges_(std::vector<word_t>& v);
+
+    void fill_(random_t& random);
+    void smooth_();
+    void write_(map& out);
+
+    params_t params_;
+
+    int    w_     = 0;
+    int    h_     = 0;
+    size_t words_ = 0; //!< words per row
+    word_t last_  = 0; //!< bits of the last word of a row past the right edge
+
+    std::vector<word_t>        cells_;
+    std::vector<word_t>        next_;
+    std::vector<word_t>        sum0_; //!< column sums of three rows; low bit
+    std::vector<word_t>        sum1_; //!< column sums of three rows; high bit
+    std::vector<tile_category> tiles_;
+    std::vector<uint32_t>      hashes_; //!< hash_random of a row
+};
+//==============================================================================
+void cave_layout::impl_t::generate_into(map& out, random_t& random) {
+    w_     = params_.map_w;
+    h_     = params_.map_h;
+    words_ = static_cast<size_t>((w_ + word_bits - 1) / word_bits);
+
+    auto const used = w_ % word_bits;
+    last_ = used ? (all_ones << used) : word_t {0};
+
+    auto const size = words_ * static_cast<size_t>(h_);
+    cells_.resize(size);
+    next_.resize(size);
+    sum0_.resize(words_);
+    sum1_.resize(words_);
+    tiles_.resize(static_cast<size_t>(w_));
+
+    fill_(random);
+
+    for (int i = 0; i < params_.iterations; ++i) {
+        smooth_();
+    }
+
+    //only a map of another size (or a read only one) needs new storage
+    if (out.width() != w_ || out.height() != h_ || out.is_read_only()) {
+        out = map {params_.map_w, params_.map_h};
+    } else {
+        out.clear();
+    }
+
+    write_(out);
+}
+//------------------------------------------------------------------------------
+void cave_layout::impl_t::close_edges_(std::vector<word_t>& v) {
+    std::fill_n(row_(v, 0), words_, all_ones);
+    std::fill_n(row_(v, h_ - 1), words_, all_ones);
+
+    auto const right_word = static_cast<size_t>((w_ - 1) / word_bits);
+    auto const right_bit  = word_t {1} << ((w_ - 1) % word_bits);
+
+    for (int y = 1; y < h_ - 1; ++y) {
+        auto const row = row_(v, y);
+        row[0]          |= word_t {1};
+        row[right_word] |= right_bit;
+        row[words_ - 1] |= last_;
+    }
+}
+//------------------------------------------------------------------------------
+void cave_layout::impl_t::fill_(random_t& random) {
+    //the chance in 2^-32 units
+    auto const threshold = (static_cast<uint64_t>(params_.wall_chance) << 32) / 100;
+
+    //each tile depends on the seed and its position only
+    auto const hi   = uint64_t {detail::random_bits32(random)};
+    auto const lo   = uint64_t {detail::random_bits32(random)};
+    auto const seed = (hi << 32) | lo;
+
+    hashes_.resize(words_ * word_bits);
+
+    for (int y = 0; y < h_; ++y) {
+        hash_random_row(seed, params_.x0, params_.y0 + y, 0, hashes_.data(), static_cast<size_t>(w_));
+
+        auto const row = row_(cells_, y);
+        for (size_t i = 0; i < words_; ++i) {
+            auto const tiles = hashes_.data() + i * word_bits;
+
+            word_t bits = 0;
+            for (int b = 0; b < word_bits; ++b) {
+                bits |= word_t {tiles[b] < threshold} << b;
+            }
+
+            row[i] = bits;
+        }
+    }
+
+    close_edges_(cells_);
+}
+//------------------------------------------------------------------------------
+void cave_layout::impl_t::smooth_() {
+    auto const n = words_;
+
+    for (int y = 0; y < h_; ++y) {
+        //the rows above the first and below the last are all wall
+        auto const b = row_(cells_, y);
+        auto const a = (y > 0)      ? row_(cells_, y - 1) : nullptr;
+        auto const c = (y + 1 < h_) ? row_(cells_, y + 1) : nullptr;
+
+        //the number of walls in each column of the three rows as two bits
+        for (size_t i = 0; i < n; ++i) {
+            auto const ai = a ? a[i] : all_ones;
+            auto const ci = c ? c[i] : all_ones;
+            auto const bi = b[i];
+
+            sum0_[i] = ai ^ bi ^ ci;
+            sum1_[i] = (ai & bi) | (ci & (ai ^ bi));
+        }
+
+        //add the column sums to the west, at and to the east of each tile;
+        //columns past either edge are all wall
+        auto const out = row_(next_, y);
+        for (size_t i = 0; i < n; ++i) {
+            auto const prev0 = i > 0     ? sum0_[i - 1] : all_ones;
+            auto const prev1 = i > 0     ? sum1_[i - 1] : all_ones;
+            auto const next0 = i + 1 < n ? sum0_[i + 1] : all_ones;
+            auto const next1 = i + 1 < n ? sum1_[i + 1] : all_ones;
+
+            auto const c0 = sum0_[i];
+            auto const c1 = sum1_[i];
+            auto const w0 = (c0 << 1) | (prev0 >> (word_bits - 1));
+            auto const w1 = (c1 << 1) | (prev1 >> (word_bits - 1));
+            auto const e0 = (c0 >> 1) | (next0 << (word_bits - 1));
+            auto const e1 = (c1 >> 1) | (next1 << (word_bits - 1));
+
+            //west + center: x2 x1 x0
+            auto const k  = w0 & c0;
+            auto const x0 = w0 ^ c0;
+            auto const x1 = w1 ^ c1 ^ k;
+            auto const x2 = (w1 & c1) | (k & (w1 ^ c1));
+
+            //+ east: y3 y2 y1 y0
+            auto const k0 = x0 & e0;
+            auto const y0 = x0 ^ e0;
+            auto const y1 = x1 ^ e1 ^ k0;
+            auto const k1 = (x1 & e1) | (k0 & (x1 ^ e1));
+            auto const y2 = x2 ^ k1;
+            auto const y3 = x2 & k1;
+
+            //at least 5 walls
+            out[i] = y3 | (y2 & (y1 | y0));
+        }
+    }
+
+    close_edges_(next_);
+    std::swap(cells_, next_);
+}
+//------------------------------------------------------------------------------
+void cave_layout::impl_t::write_(map& out) {
+    for (int y = 0; y < h_; ++y) {
+        auto const row = row_(cells_, y);
+
+        for (int x = 0; x < w_; ++x) {
+            auto const bit = (row[x / word_bits] >> (x % word_bits)) & 1;
+            tiles_[static_cast<size_t>(x)] = bit ? tile_category::wall : tile_category::floor;
+        }
+
+        out.write_rect<map_property::category>(rect_t {0, y, w_, y + 1}, tiles_.data());
+    }
+}
+
+//==============================================================================
+cave_layout::cave_layout(params_t p)
+  : impl_ {std::make_unique<impl_t>(p)}
+{
+}
+//------------------------------------------------------------------------------
+cave_layout::~cave_layout() {
+}
+//------------------------------------------------------------------------------
+cave_layout::params_t cave_layout::params() const {
+    return impl_->params();
+}
+//------------------------------------------------------------------------------
+void cave_layout::set_params(params_t const p) {
+    impl_->set_params(p);
+}
+//------------------------------------------------------------------------------
+yama::map cave_layout::generate(random_t& random) {
+    return impl_->generate(random);
+}
+//------------------------------------------------------------------------------
+void cave_layout::generate_into(map& out, random_t& random) {
+    impl_->generate_into(out, random);
+}
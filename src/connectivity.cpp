@@ -0,0 +1,210 @@
+#include "pch.hpp"
+#include "connectivity.hpp"
+
+#include <memory>
+#include <numeric>
+#include <thread>
+
+using yama::grid;
+using yama::component_label_t;
+
+namespace {
+
+using index_t = uint32_t;
+
+//! bands are at least this many rows; smaller maps aren't worth a thread.
+int const min_band_rows = 64;
+
+//! the root of @p i without path compression; safe to call concurrently.
+inline index_t find_root(index_t const* const parent, index_t i) {
+    while (parent[i] != i) {
+        i = parent[i];
+    }
+    return i;
+}
+
+//! the root of @p i with path halving.
+inline index_t find_compress(index_t* const parent, index_t i) {
+    while (parent[i] != i) {
+        parent[i] = parent[parent[i]];
+        i = parent[i];
+    }
+    return i;
+}
+
+//! join the trees of @p a and @p b; the smaller index becomes the root, so a
+//! component's root is its first tile in raster order.
+inline void unite(index_t* const parent, index_t const a, index_t const b) {
+    auto const ra = find_compress(parent, a);
+    auto const rb = find_compress(parent, b);
+
+    if (ra < rb) {
+        parent[rb] = ra;
+    } else if (rb < ra) {
+        parent[ra] = rb;
+    }
+}
+
+//! call function(band) for every band in [0, bands); band 0 on this thread.
+template <typename F>
+void for_each_band(int const bands, F&& function) {
+    if (bands == 1) {
+        function(0);
+        return;
+    }
+
+    std::vector<std::thread> threads;
+    threads.reserve(static_cast<size_t>(bands - 1));
+
+    for (int band = 1; band < bands; ++band) {
+        threads.emplace_back([&function, band] { function(band); });
+    }
+
+    function(0);
+
+    for (auto& t : threads) {
+        t.join();
+    }
+}
+
+} //namespace
+
+int yama::detail::label_mask(grid<uint8_t> const& mask, grid<component_label_t>& labels, int const thread_count) {
+    BK_ASSERT(labels.width() == mask.width() && labels.height() == mask.height());
+
+    auto const w = mask.width();
+    auto const h = mask.height();
+
+    auto const threads = thread_count > 0
+      ? thread_count
+      : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+    auto const bands = std::max(1, std::min(threads, h / min_band_rows));
+
+    auto const band_top = [&](int const band) {
+        return static_cast<int>(static_cast<int64_t>(h) * band / bands);
+    };
+
+    auto const index_of = [w](int const x, int const y) {
+        return static_cast<index_t>(x) + static_cast<index_t>(y) * static_cast<index_t>(w);
+    };
+
+    //only open tiles are given (and follow) parents
+    std::unique_ptr<index_t[]> parent {new index_t[static_cast<size_t>(w) * static_cast<size_t>(h)]};
+    auto const p = parent.get();
+
+    //label each band independently; unions only touch tiles in the band.
+    for_each_band(bands, [&](int const band) {
+        auto const y0 = band_top(band);
+        auto const y1 = band_top(band + 1);
+
+        for (auto y = y0; y < y1; ++y) {
+            auto const row   = mask.row(y);
+            auto const above = (y > y0) ? mask.row(y - 1) : nullptr;
+
+            index_t run = 0; //the first tile of the current run of open tiles
+
+            for (int x = 0; x < w; ++x) {
+                if (!row[x]) {
+                    continue;
+                }
+
+                auto const i    = index_of(x, y);
+                auto const left = x > 0 && row[x - 1];
+                auto const up   = above && above[x];
+
+                //link to the start of the run, not the previous tile, to keep trees shallow
+                if (left) {
+                    p[i] = run;
+                } else {
+                    p[i] = i;
+                    run  = i;
+                }
+
+                //if up-left is open, up and left are already joined through it
+                if (up && !(left && above[x - 1])) {
+                    unite(p, i, i - static_cast<index_t>(w));
+                }
+            }
+        }
+    });
+
+    //merge along band boundaries
+    for (int band = 1; band < bands; ++band) {
+        auto const y     = band_top(band);
+        auto const row   = mask.row(y);
+        auto const above = mask.row(y - 1);
+
+        for (int x = 0; x < w; ++x) {
+            if (row[x] && above[x]) {
+                unite(p, index_of(x, y), index_of(x, y - 1));
+            }
+        }
+    }
+
+    auto const out = labels.row(0);
+
+    //label the roots of a band in raster order, starting after @p next.
+    auto const number_roots = [&](int const band, index_t next) {
+        for (auto y = band_top(band); y < band_top(band + 1); ++y) {
+            auto const row = mask.row(y);
+            for (int x = 0; x < w; ++x) {
+                auto const i = index_of(x, y);
+                if (row[x] && p[i] == i) {
+                    out[i] = ++next;
+                }
+            }
+        }
+        return next;
+    };
+
+    //give every other tile the label of its root; roots come first in raster
+    //order so a single band can number and resolve in one pass.
+    auto const resolve = [&](int const band, bool const numbered, index_t next) {
+        for (auto y = band_top(band); y < band_top(band + 1); ++y) {
+            auto const row = mask.row(y);
+            for (int x = 0; x < w; ++x) {
+                auto const i = index_of(x, y);
+                if (!row[x]) {
+                    out[i] = 0;
+                } else if (p[i] != i) {
+                    out[i] = out[find_root(p, i)];
+                } else if (!numbered) {
+                    out[i] = ++next;
+                }
+            }
+        }
+        return next;
+    };
+
+    if (bands == 1) {
+        return static_cast<int>(resolve(0, false, 0));
+    }
+
+    //count the roots of each band to find where each band's numbering starts
+    std::vector<index_t> roots (static_cast<size_t>(bands) + 1);
+
+    for_each_band(bands, [&](int const band) {
+        index_t count = 0;
+        for (auto y = band_top(band); y < band_top(band + 1); ++y) {
+            auto const row = mask.row(y);
+            for (int x = 0; x < w; ++x) {
+                auto const i = index_of(x, y);
+                count += (row[x] && p[i] == i) ? 1 : 0;
+            }
+        }
+        roots[static_cast<size_t>(band) + 1] = count;
+    });
+
+    std::partial_sum(roots.begin(), roots.end(), roots.begin());
+
+    for_each_band(bands, [&](int const band) {
+        number_roots(band, roots[static_cast<size_t>(band)]);
+    });
+
+    for_each_band(bands, [&](int const band) {
+        resolve(band, true, 0);
+    });
+
+    return static_cast<int>(roots.back());
+}
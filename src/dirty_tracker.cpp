@@ -0,0 +1,142 @@
+#include "pch.hpp"
+#include "dirty_tracker.hpp"
+
+using yama::dirty_tracker;
+
+dirty_tracker::dirty_tracker(int const Width, int const Height)
+  : width_    {Width}
+  , height_   {Height}
+  , chunks_w_ {(Width  + chunk_size - 1) >> chunk_bits}
+  , chunks_h_ {(Height + chunk_size - 1) >> chunk_bits}
+  , row_words_ {(static_cast<size_t>(chunks_w_) + 63) / 64}
+  , words_    {row_words_ * static_cast<size_t>(chunks_h_)}
+  , current_  {0}
+  , bits_     (words_ * history)
+{
+    BK_ASSERT(width_ > 0 && height_ > 0);
+    mark_all();
+}
+
+void dirty_tracker::mark(rect_t const r) {
+    BK_ASSERT(r.left >= 0 && r.top >= 0 && r.right <= width_ && r.bottom <= height_);
+
+    if (!r) {
+        return;
+    }
+
+    auto const cx0 = r.left >> chunk_bits;
+    auto const cx1 = (r.right - 1) >> chunk_bits;
+    auto const cy0 = r.top >> chunk_bits;
+    auto const cy1 = (r.bottom - 1) >> chunk_bits;
+
+    for (auto cy = cy0; cy <= cy1; ++cy) {
+        for (auto cx = cx0; cx <= cx1; ++cx) {
+            auto const c = bit_(cx, cy);
+            bits_[current_ + (c >> 6)] |= uint64_t {1} << (c & 63);
+        }
+    }
+}
+
+void dirty_tracker::mark_all() {
+    mark(rect_t {0, 0, width_, height_});
+}
+
+dirty_tracker::epoch_t dirty_tracker::next_epoch() {
+    ++epoch_;
+
+    current_ = static_cast<size_t>(epoch_ % history) * words_;
+    std::fill_n(bits_.begin() + static_cast<ptrdiff_t>(current_), words_, uint64_t {0});
+
+    return epoch_;
+}
+
+bool dirty_tracker::collect_(epoch_t const since, std::vector<uint64_t>& out) const {
+    out.assign(words_, 0);
+
+    if (since > epoch_) {
+        return true;
+    }
+
+    if (epoch_ - since >= static_cast<epoch_t>(history)) {
+        return false;
+    }
+
+    for (auto e = since; e <= epoch_; ++e) {
+        auto const first = bits_.begin() + static_cast<ptrdiff_t>((e % history) * words_);
+        std::transform(out.begin(), out.end(), first, out.begin()
+          , [](uint64_t const a, uint64_t const b) { return a | b; });
+    }
+
+    return true;
+}
+
+bool dirty_tracker::is_changed_since(epoch_t const since) const {
+    std::vector<uint64_t> bits;
+    if (!collect_(since, bits)) {
+        return true;
+    }
+
+    return std::any_of(bits.begin(), bits.end(), [](uint64_t const w) { return w != 0; });
+}
+
+std::vector<yama::rect_t> dirty_tracker::changed_since(epoch_t const since) const {
+    std::vector<rect_t> result;
+
+    std::vector<uint64_t> bits;
+    if (!collect_(since, bits)) {
+        result.emplace_back(0, 0, width_, height_);
+        return result;
+    }
+
+    auto const is_set = [&](int const cx, int const cy) {
+        auto const c = bit_(cx, cy);
+        return (bits[c >> 6] >> (c & 63)) & 1;
+    };
+
+    //runs of dirty chunks in a row; a run identical to one directly above
+    //extends that rect downwards rather than starting a new one.
+    std::vector<size_t> open;  //indices into result of rects ending on the previous row
+    std::vector<size_t> next;
+
+    for (int cy = 0; cy < chunks_h_; ++cy) {
+        next.clear();
+
+        auto above = open.begin();
+
+        for (int cx = 0; cx < chunks_w_;) {
+            if (!is_set(cx, cy)) {
+                ++cx;
+                continue;
+            }
+
+            auto const x0 = cx;
+            while (cx < chunks_w_ && is_set(cx, cy)) {
+                ++cx;
+            }
+
+            while (above != open.end() && result[*above].left < x0) {
+                ++above;
+            }
+
+            if (above != open.end() && result[*above].left == x0 && result[*above].right == cx) {
+                result[*above].bottom = cy + 1;
+                next.push_back(*above++);
+            } else {
+                next.push_back(result.size());
+                result.emplace_back(x0, cy, cx, cy + 1);
+            }
+        }
+
+        std::swap(open, next);
+    }
+
+    //chunks to tiles
+    for (auto& r : result) {
+        r.left   = r.left << chunk_bits;
+        r.top    = r.top  << chunk_bits;
+        r.right  = std::min(r.right  << chunk_bits, width_);
+        r.bottom = std::min(r.bottom << chunk_bits, height_);
+    }
+
+    return result;
+}
@@ -1,8 +1,194 @@
 #include "pch.hpp"
 #include "generate.hpp"
 
+#include <array>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <vector>
+
 using namespace yama;
 
+namespace {
+
+//! fill @p out with the chance of each value of weighted_range.
+void weighted_range_weights(
+    int const size, double const mean, double const stddev, std::vector<double>& out
+) {
+    out.assign(static_cast<size_t>(size), 0.0);
+
+    //value k is the normal variate n rounded from lower + (size - 1) * n
+    auto const delta = static_cast<double>(size - 1);
+
+    if (stddev <= 0.0) {
+        out[static_cast<size_t>(std::round(delta * mean))] = 1.0;
+        return;
+    }
+
+    auto const cdf = [&](double const k) {
+        return 0.5 * std::erfc((mean - k / delta) / (stddev * std::sqrt(2.0)));
+    };
+
+    for (int k = 0; k < size; ++k) {
+        out[static_cast<size_t>(k)] = cdf(k + 0.5) - cdf(k - 0.5);
+    }
+}
+
+struct weighted_range_key {
+    int lower;
+    int upper;
+    int weight;
+    int variance;
+
+    friend bool operator==(weighted_range_key const& a, weighted_range_key const& b) {
+        return a.lower == b.lower && a.upper == b.upper
+            && a.weight == b.weight && a.variance == b.variance;
+    }
+};
+
+size_t hash_of(weighted_range_key const& k) {
+    auto h = uint64_t {14695981039346656037ull};
+    for (auto const v : {k.lower, k.upper, k.weight, k.variance}) {
+        h = (h ^ static_cast<uint32_t>(v)) * 1099511628211ull;
+    }
+    return static_cast<size_t>(h);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Walker's alias method (Vose's construction): a value in [0, size) from one
+//! bounded draw and at most one more for the coin.
+////////////////////////////////////////////////////////////////////////////////
+struct alias_table {
+    uint64_t const* keep;  //!< the chance of keeping i, in 2^-32 units.
+    uint32_t const* alias; //!< the value taken otherwise.
+    uint32_t        size;
+
+    int sample(random_t& random) const {
+        auto const i = detail::bounded_random(random, size);
+        auto const k = keep[i];
+
+        if (k > std::numeric_limits<uint32_t>::max()) {
+            return static_cast<int>(i);
+        }
+
+        return detail::random_bits32(random) < k
+          ? static_cast<int>(i)
+          : static_cast<int>(alias[i]);
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+//! The alias tables of one thread, in a direct mapped cache.
+//!
+//! Tables are appended to one preallocated arena; when it is full every table
+//! is forgotten and the arena reused. The arena and the build scratch only
+//! ever grow, so once they fit the largest table asked for, building a table
+//! for a new key allocates nothing.
+////////////////////////////////////////////////////////////////////////////////
+class alias_table_cache {
+public:
+    alias_table_cache() {
+        keep_.reserve(arena_size);
+        alias_.reserve(arena_size);
+
+        scaled_.reserve(scratch_size);
+        small_.reserve(scratch_size);
+        large_.reserve(scratch_size);
+        weights_.reserve(scratch_size);
+    }
+
+    //! the table for @p key; valid until the next call.
+    alias_table get(weighted_range_key const& key) {
+        auto& slot = slots_[hash_of(key) % slot_count];
+        if (!slot.valid || !(slot.key == key)) {
+            build_(slot, key);
+        }
+
+        return alias_table {keep_.data() + slot.offset, alias_.data() + slot.offset, slot.size};
+    }
+private:
+    static size_t const slot_count   = 256;
+    static size_t const arena_size   = 1 << 13; //!< entries; 96 KiB.
+    static size_t const scratch_size = 256;
+
+    struct slot_t {
+        weighted_range_key key;
+        bool               valid;
+        uint32_t           offset;
+        uint32_t           size;
+    };
+
+    void build_(slot_t& slot, weighted_range_key const& key);
+
+    std::array<slot_t, slot_count> slots_ {};
+
+    std::vector<uint64_t> keep_;
+    std::vector<uint32_t> alias_;
+
+    std::vector<double>   weights_;
+    std::vector<double>   scaled_;
+    std::vector<uint32_t> small_;
+    std::vector<uint32_t> large_;
+};
+//------------------------------------------------------------------------------
+void alias_table_cache::build_(slot_t& slot, weighted_range_key const& key) {
+    constexpr auto range = double {closed_range<int, 100>::check_type::range};
+
+    auto const mean   = ((key.weight   / range) + 1.0) / 2.0;
+    auto const stddev = ((key.variance / range) + 1.0) / 2.0;
+    auto const n      = static_cast<size_t>(key.upper - key.lower + 1);
+
+    weighted_range_weights(static_cast<int>(n), mean, stddev, weights_);
+
+    //out of room; forget every table
+    if (keep_.size() + n > keep_.capacity() && !keep_.empty()) {
+        for (auto& s : slots_) {
+            s.valid = false;
+        }
+
+        keep_.clear();
+        alias_.clear();
+    }
+
+    auto const offset = keep_.size();
+    keep_.resize(offset + n, uint64_t {1} << 32);
+    alias_.resize(offset + n, 0);
+
+    auto const keep  = keep_.data() + offset;
+    auto const alias = alias_.data() + offset;
+    auto const total = std::accumulate(weights_.begin(), weights_.end(), 0.0);
+
+    //each column holds an average share of 1
+    scaled_.resize(n);
+    small_.clear();
+    large_.clear();
+
+    for (uint32_t i = 0; i < n; ++i) {
+        scaled_[i] = weights_[i] * static_cast<double>(n) / total;
+        (scaled_[i] < 1.0 ? small_ : large_).push_back(i);
+    }
+
+    while (!small_.empty() && !large_.empty()) {
+        auto const sm = small_.back(); small_.pop_back();
+        auto const lg = large_.back();
+
+        keep[sm]  = static_cast<uint64_t>(scaled_[sm] * 4294967296.0);
+        alias[sm] = lg;
+
+        scaled_[lg] -= 1.0 - scaled_[sm];
+        if (scaled_[lg] < 1.0) {
+            large_.pop_back();
+            small_.push_back(lg);
+        }
+    }
+
+    //whatever is left is full up to rounding; it keeps the default
+
+    slot = slot_t {key, true, static_cast<uint32_t>(offset), static_cast<uint32_t>(n)};
+}
+
+} //namespace
+
 //==============================================================================
 int generate::weighted_range(
     random_t&                           random
@@ -10,31 +196,16 @@ int generate::weighted_range(
   , closed_range<int, 100>        const weight
   , closed_range<int, 100>        const variance
 ) {
-    using T = double;
-
-    constexpr auto range_mean   = T{decltype(weight)::check_type::range};
-    constexpr auto range_stddev = T{decltype(variance)::check_type::range};
-
-    auto const mean   = ((weight   / range_mean)   + T{1}) / T{2};
-    auto const stddev = ((variance / range_stddev) + T{1}) / T{2};
-    auto       dist   = std::normal_distribution<T> {mean, stddev};
-    
-    auto const a           = static_cast<T>(range.lower);
-    auto const b           = static_cast<T>(range.upper);
-    auto const delta       = b - a;
-    auto const lower_limit = (T{0}  - T{0.5}) / delta;
-    auto const upper_limit = (delta + T{0.5}) / delta;
-
-    auto const in_range = [&](T const n) {
-        return n > lower_limit && n < upper_limit;
-    };
-
-    auto n = dist(random);
-    while (!in_range(n)) {
-        n = dist(random);
+    if (range.lower == range.upper) {
+        return range.lower;
     }
 
-    return static_cast<int>(std::round(a + delta * n));
+    thread_local alias_table_cache tables;
+
+    auto const table = tables.get(
+        weighted_range_key {range.lower, range.upper, weight, variance});
+
+    return range.lower + table.sample(random);
 }
 //==============================================================================
 rect_t
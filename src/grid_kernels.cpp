@@ -0,0 +1,368 @@
+#include "pch.hpp"
+#include "grid_kernels.hpp"
+
+#include <boost/predef.h>
+
+#include <limits>
+
+#if defined(__AVX2__)
+#   define YAMA_KERNELS_AVX2
+#   define YAMA_KERNELS_SSE2
+#   include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define YAMA_KERNELS_SSE2
+#   include <emmintrin.h>
+#endif
+
+#if BOOST_COMP_MSVC
+#   include <intrin.h>
+#endif
+
+namespace {
+
+inline size_t popcount(uint32_t const n) {
+#if BOOST_COMP_MSVC
+    return __popcnt(n);
+#else
+    return static_cast<size_t>(__builtin_popcount(n));
+#endif
+}
+
+//==============================================================================
+// scalar kernels; also used for the tail of each row by the vector kernels.
+//==============================================================================
+template <typename U>
+size_t scalar_count_equal(U const* const row, size_t i, size_t const n, U const value) {
+    size_t result = 0;
+    for (; i < n; ++i) {
+        result += (row[i] == value) ? 1 : 0;
+    }
+    return result;
+}
+
+template <typename U>
+void scalar_replace(U* const row, size_t i, size_t const n, U const from, U const to) {
+    for (; i < n; ++i) {
+        row[i] = (row[i] == from) ? to : row[i];
+    }
+}
+
+template <typename U>
+size_t scalar_diff_mask(U const* const a, U const* const b, size_t i, size_t const n, uint8_t* const out) {
+    size_t result = 0;
+    for (; i < n; ++i) {
+        auto const d = (a[i] != b[i]) ? 1 : 0;
+        out[i] = static_cast<uint8_t>(d);
+        result += d;
+    }
+    return result;
+}
+
+//! four interleaved sub-histograms so runs of one value don't serialize on a
+//! single counter; shared by all @p rows rows, @p stride values apart.
+template <typename U>
+void scalar_histogram(
+    U const*           row
+  , size_t       const stride
+  , size_t       const n
+  , size_t       const rows
+  , size_t*      const counts
+  , int          const bins
+) {
+    std::vector<size_t> sub (static_cast<size_t>(bins) * 4);
+    auto const b = static_cast<size_t>(bins);
+
+    auto const add = [&](size_t const lane, U const v) {
+        if (v < b) {
+            ++sub[lane * b + v];
+        }
+    };
+
+    for (size_t y = 0; y < rows; ++y, row += stride) {
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4) {
+            add(0, row[i + 0]);
+            add(1, row[i + 1]);
+            add(2, row[i + 2]);
+            add(3, row[i + 3]);
+        }
+
+        for (; i < n; ++i) {
+            add(0, row[i]);
+        }
+    }
+
+    for (size_t v = 0; v < b; ++v) {
+        counts[v] += sub[v] + sub[b + v] + sub[2 * b + v] + sub[3 * b + v];
+    }
+}
+
+#if defined(YAMA_KERNELS_SSE2)
+//==============================================================================
+// vector kernels, written once against an instruction set policy.
+//==============================================================================
+template <size_t Size> using size_tag = std::integral_constant<size_t, Size>;
+
+struct sse2 {
+    using reg = __m128i;
+    static size_t const bytes = 16;
+
+    static reg  load(void const* const p)     { return _mm_loadu_si128(static_cast<reg const*>(p)); }
+    static void store(void* const p, reg const v) { _mm_storeu_si128(static_cast<reg*>(p), v); }
+
+    static reg splat(uint8_t  const v) { return _mm_set1_epi8(static_cast<char>(v)); }
+    static reg splat(uint16_t const v) { return _mm_set1_epi16(static_cast<short>(v)); }
+    static reg splat(uint32_t const v) { return _mm_set1_epi32(static_cast<int>(v)); }
+
+    static reg cmpeq(reg const a, reg const b, size_tag<1>) { return _mm_cmpeq_epi8(a, b); }
+    static reg cmpeq(reg const a, reg const b, size_tag<2>) { return _mm_cmpeq_epi16(a, b); }
+    static reg cmpeq(reg const a, reg const b, size_tag<4>) { return _mm_cmpeq_epi32(a, b); }
+
+    //! m ? a : b for each bit.
+    static reg select(reg const m, reg const a, reg const b) {
+        return _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b));
+    }
+
+    static reg sub(reg const a, reg const b, size_tag<1>) { return _mm_sub_epi8(a, b); }
+    static reg sub(reg const a, reg const b, size_tag<2>) { return _mm_sub_epi16(a, b); }
+    static reg sub(reg const a, reg const b, size_tag<4>) { return _mm_sub_epi32(a, b); }
+
+    static reg zero() { return _mm_setzero_si128(); }
+
+    static uint32_t mask(reg const v) { return static_cast<uint32_t>(_mm_movemask_epi8(v)); }
+};
+
+#if defined(YAMA_KERNELS_AVX2)
+struct avx2 {
+    using reg = __m256i;
+    static size_t const bytes = 32;
+
+    static reg  load(void const* const p)     { return _mm256_loadu_si256(static_cast<reg const*>(p)); }
+    static void store(void* const p, reg const v) { _mm256_storeu_si256(static_cast<reg*>(p), v); }
+
+    static reg splat(uint8_t  const v) { return _mm256_set1_epi8(static_cast<char>(v)); }
+    static reg splat(uint16_t const v) { return _mm256_set1_epi16(static_cast<short>(v)); }
+    static reg splat(uint32_t const v) { return _mm256_set1_epi32(static_cast<int>(v)); }
+
+    static reg cmpeq(reg const a, reg const b, size_tag<1>) { return _mm256_cmpeq_epi8(a, b); }
+    static reg cmpeq(reg const a, reg const b, size_tag<2>) { return _mm256_cmpeq_epi16(a, b); }
+    static reg cmpeq(reg const a, reg const b, size_tag<4>) { return _mm256_cmpeq_epi32(a, b); }
+
+    static reg select(reg const m, reg const a, reg const b) {
+        return _mm256_blendv_epi8(b, a, m);
+    }
+
+    static reg sub(reg const a, reg const b, size_tag<1>) { return _mm256_sub_epi8(a, b); }
+    static reg sub(reg const a, reg const b, size_tag<2>) { return _mm256_sub_epi16(a, b); }
+    static reg sub(reg const a, reg const b, size_tag<4>) { return _mm256_sub_epi32(a, b); }
+
+    static reg zero() { return _mm256_setzero_si256(); }
+
+    static uint32_t mask(reg const v) { return static_cast<uint32_t>(_mm256_movemask_epi8(v)); }
+};
+
+using isa = avx2;
+#else
+using isa = sse2;
+#endif
+
+template <typename Isa, typename U>
+size_t vector_count_equal(U const* const row, size_t const n, U const value) {
+    size_t const per = Isa::bytes / sizeof(U);
+
+    auto const v = Isa::splat(value);
+
+    size_t i    = 0;
+    size_t bits = 0; //set bytes; sizeof(U) per equal value
+    for (; i + per <= n; i += per) {
+        bits += popcount(Isa::mask(Isa::cmpeq(Isa::load(row + i), v, size_tag<sizeof(U)> {})));
+    }
+
+    return bits / sizeof(U) + scalar_count_equal(row, i, n, value);
+}
+
+template <typename Isa, typename U>
+void vector_replace(U* const row, size_t const n, U const from, U const to) {
+    size_t const per = Isa::bytes / sizeof(U);
+
+    auto const f = Isa::splat(from);
+    auto const t = Isa::splat(to);
+
+    size_t i = 0;
+    for (; i + per <= n; i += per) {
+        auto const v = Isa::load(row + i);
+        Isa::store(row + i, Isa::select(Isa::cmpeq(v, f, size_tag<sizeof(U)> {}), t, v));
+    }
+
+    scalar_replace(row, i, n, from, to);
+}
+
+//! the number of bins vector_histogram handles.
+int const vector_histogram_bins = 8;
+
+////////////////////////////////////////////////////////////////////////////////
+//! One pass histogram for bins <= vector_histogram_bins: each bin has a vector
+//! of per-lane counters, incremented by subtracting the (all ones) comparison
+//! result, and spilled before the lanes can overflow.
+////////////////////////////////////////////////////////////////////////////////
+template <typename Isa, typename U>
+void vector_histogram(U const* const row, size_t const n, size_t* const counts, int const bins) {
+    using reg = typename Isa::reg;
+
+    size_t const per   = Isa::bytes / sizeof(U);
+    size_t const spill = std::numeric_limits<U>::max() < 0xFFFFu ? std::numeric_limits<U>::max() : 0xFFFFu;
+
+    reg values[vector_histogram_bins];
+    reg acc[vector_histogram_bins];
+
+    for (int v = 0; v < bins; ++v) {
+        values[v] = Isa::splat(static_cast<U>(v));
+        acc[v]    = Isa::zero();
+    }
+
+    auto const flush = [&] {
+        for (int v = 0; v < bins; ++v) {
+            U lanes[Isa::bytes / sizeof(U)];
+            Isa::store(lanes, acc[v]);
+            for (auto const lane : lanes) {
+                counts[v] += lane;
+            }
+            acc[v] = Isa::zero();
+        }
+    };
+
+    size_t i = 0;
+    size_t k = 0;
+    for (; i + per <= n; i += per) {
+        auto const x = Isa::load(row + i);
+        for (int v = 0; v < bins; ++v) {
+            acc[v] = Isa::sub(acc[v], Isa::cmpeq(x, values[v], size_tag<sizeof(U)> {}), size_tag<sizeof(U)> {});
+        }
+
+        if (++k == spill) {
+            flush();
+            k = 0;
+        }
+    }
+
+    flush();
+
+    for (; i < n; ++i) {
+        if (row[i] < static_cast<size_t>(bins)) {
+            ++counts[row[i]];
+        }
+    }
+}
+
+//! the SSE2 comparison of 16 values from a and b narrowed to 16 bytes of
+//! 0xFF (equal) or 0x00 (different).
+inline __m128i equal_bytes(uint8_t const* const a, uint8_t const* const b) {
+    return _mm_cmpeq_epi8(sse2::load(a), sse2::load(b));
+}
+
+inline __m128i equal_bytes(uint16_t const* const a, uint16_t const* const b) {
+    auto const lo = _mm_cmpeq_epi16(sse2::load(a),     sse2::load(b));
+    auto const hi = _mm_cmpeq_epi16(sse2::load(a + 8), sse2::load(b + 8));
+    return _mm_packs_epi16(lo, hi);
+}
+
+inline __m128i equal_bytes(uint32_t const* const a, uint32_t const* const b) {
+    auto const q0 = _mm_cmpeq_epi32(sse2::load(a),      sse2::load(b));
+    auto const q1 = _mm_cmpeq_epi32(sse2::load(a + 4),  sse2::load(b + 4));
+    auto const q2 = _mm_cmpeq_epi32(sse2::load(a + 8),  sse2::load(b + 8));
+    auto const q3 = _mm_cmpeq_epi32(sse2::load(a + 12), sse2::load(b + 12));
+    return _mm_packs_epi16(_mm_packs_epi32(q0, q1), _mm_packs_epi32(q2, q3));
+}
+
+//! SSE2 only; AVX2 packs within 128 bit lanes, which would reorder the output.
+template <typename U>
+size_t vector_diff_mask(U const* const a, U const* const b, size_t const n, uint8_t* const out) {
+    auto const one = _mm_set1_epi8(1);
+
+    size_t i      = 0;
+    size_t result = 0;
+    for (; i + 16 <= n; i += 16) {
+        auto const eq = equal_bytes(a + i, b + i);
+        sse2::store(out + i, _mm_andnot_si128(eq, one));
+        result += 16 - popcount(sse2::mask(eq));
+    }
+
+    return result + scalar_diff_mask(a, b, i, n, out);
+}
+#endif //YAMA_KERNELS_SSE2
+
+} //namespace
+
+//==============================================================================
+char const* yama::grid_kernels_isa() {
+#if defined(YAMA_KERNELS_AVX2)
+    return "avx2";
+#elif defined(YAMA_KERNELS_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+template <typename U>
+size_t yama::detail::count_equal_row(U const* const row, size_t const n, U const value) {
+#if defined(YAMA_KERNELS_SSE2)
+    return vector_count_equal<isa>(row, n, value);
+#else
+    return scalar_count_equal(row, 0, n, value);
+#endif
+}
+
+template <typename U>
+void yama::detail::replace_row(U* const row, size_t const n, U const from, U const to) {
+#if defined(YAMA_KERNELS_SSE2)
+    vector_replace<isa>(row, n, from, to);
+#else
+    scalar_replace(row, 0, n, from, to);
+#endif
+}
+
+template <typename U>
+size_t yama::detail::diff_mask_row(U const* const a, U const* const b, size_t const n, uint8_t* const out) {
+#if defined(YAMA_KERNELS_SSE2)
+    return vector_diff_mask(a, b, n, out);
+#else
+    return scalar_diff_mask(a, b, 0, n, out);
+#endif
+}
+
+template <typename U>
+void yama::detail::histogram_rows(
+    U const*     const row
+  , size_t       const stride
+  , size_t       const n
+  , size_t       const rows
+  , size_t*      const counts
+  , int          const bins
+) {
+#if defined(YAMA_KERNELS_SSE2)
+    if (bins <= vector_histogram_bins) {
+        for (size_t y = 0; y < rows; ++y) {
+            vector_histogram<isa>(row + y * stride, n, counts, bins);
+        }
+        return;
+    }
+#endif
+
+    scalar_histogram(row, stride, n, rows, counts, bins);
+}
+
+//==============================================================================
+//! Explicit instantiations; one line per word type.
+//==============================================================================
+#define YAMA_GRID_KERNELS_INSTANTIATE(U) \
+template size_t yama::detail::count_equal_row<U>(U const*, size_t, U); \
+template void   yama::detail::replace_row<U>(U*, size_t, U, U); \
+template size_t yama::detail::diff_mask_row<U>(U const*, U const*, size_t, uint8_t*); \
+template void   yama::detail::histogram_rows<U>(U const*, size_t, size_t, size_t, size_t*, int)
+
+YAMA_GRID_KERNELS_INSTANTIATE(uint8_t);
+YAMA_GRID_KERNELS_INSTANTIATE(uint16_t);
+YAMA_GRID_KERNELS_INSTANTIATE(uint32_t);
+
+#undef YAMA_GRID_KERNELS_INSTANTIATE
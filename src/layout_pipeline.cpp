@@ -0,0 +1,213 @@
+#include "pch.hpp"
+#include "layout_pipeline.hpp"
+
+using yama::layout_pipeline;
+using random_t = yama::random_t;
+
+namespace {
+
+int index_of(layout_pipeline::stage const s) {
+    return static_cast<int>(s);
+}
+
+} //namespace
+
+//==============================================================================
+char const* layout_pipeline::stage_name(stage const s) {
+    switch (s) {
+    case stage::tree      : return "tree";
+    case stage::rooms     : return "rooms";
+    case stage::rasterize : return "rasterize";
+    case stage::corridors : return "corridors";
+    case stage::features  : return "features";
+    default : break;
+    }
+
+    return "unknown";
+}
+//------------------------------------------------------------------------------
+layout_pipeline::tree_stage layout_pipeline::default_tree() {
+    return [](layout_t& layout, random_t& random, rect_t const bounds, tree_t& out) {
+        layout.clear();
+        layout.nodes_.push_back(node {bounds});
+        layout.generate_tree(random);
+        out.nodes = layout.nodes_;
+    };
+}
+//------------------------------------------------------------------------------
+layout_pipeline::rooms_stage layout_pipeline::default_rooms() {
+    return [](layout_t& layout, random_t& random, tree_t const& in, rooms_t& out) {
+        layout.clear();
+        layout.nodes_ = in.nodes;
+        layout.generate_rooms(random);
+        out.nodes = layout.nodes_;
+        out.rooms = layout.rooms_;
+    };
+}
+//------------------------------------------------------------------------------
+layout_pipeline::rasterize_stage layout_pipeline::default_rasterize() {
+    return [](layout_t& layout, random_t&, rooms_t const& in, map& out) {
+        BK_ASSERT(layout.map_ == &out);
+        static_cast<void>(out);
+
+        for (auto const& room : in.rooms) {
+            layout.write_room(room);
+        }
+    };
+}
+//------------------------------------------------------------------------------
+layout_pipeline::corridors_stage layout_pipeline::default_corridors() {
+    return [](layout_t& layout, random_t& random, rooms_t const& in, map& out) {
+        BK_ASSERT(layout.map_ == &out);
+        static_cast<void>(out);
+
+        layout.nodes_ = in.nodes;
+        layout.rooms_ = in.rooms;
+        layout.connect(random, layout.nodes_[0]);
+    };
+}
+//------------------------------------------------------------------------------
+layout_pipeline::features_stage layout_pipeline::default_features() {
+    return [](layout_t& layout, random_t& random, rooms_t const& in, map& out, features_t& features) {
+        BK_ASSERT(layout.map_ == &out);
+        static_cast<void>(out);
+
+        layout.rooms_ = in.rooms;
+
+        grid_position_t stairs[2];
+        auto const n = layout.place_stairs(random, stairs);
+        features.stairs.assign(stairs, stairs + n);
+    };
+}
+
+//==============================================================================
+layout_pipeline::layout_pipeline(params_t const params)
+  : layout_          {params}
+  , tree_stage_      {default_tree()}
+  , rooms_stage_     {default_rooms()}
+  , rasterize_stage_ {default_rasterize()}
+  , corridors_stage_ {default_corridors()}
+  , features_stage_  {default_features()}
+{
+}
+//------------------------------------------------------------------------------
+layout_pipeline::params_t layout_pipeline::params() const {
+    return layout_.params();
+}
+//------------------------------------------------------------------------------
+void layout_pipeline::set_params(params_t const params) {
+    layout_.set_params(params);
+    invalidate(stage::tree);
+}
+//------------------------------------------------------------------------------
+void layout_pipeline::set_tree_stage(tree_stage f) {
+    tree_stage_ = std::move(f);
+    invalidate(stage::tree);
+}
+//------------------------------------------------------------------------------
+void layout_pipeline::set_rooms_stage(rooms_stage f) {
+    rooms_stage_ = std::move(f);
+    invalidate(stage::rooms);
+}
+//------------------------------------------------------------------------------
+void layout_pipeline::set_rasterize_stage(rasterize_stage f) {
+    rasterize_stage_ = std::move(f);
+    invalidate(stage::rasterize);
+}
+//------------------------------------------------------------------------------
+void layout_pipeline::set_corridors_stage(corridors_stage f) {
+    corridors_stage_ = std::move(f);
+    invalidate(stage::corridors);
+}
+//------------------------------------------------------------------------------
+void layout_pipeline::set_features_stage(features_stage f) {
+    features_stage_ = std::move(f);
+    invalidate(stage::features);
+}
+//------------------------------------------------------------------------------
+void layout_pipeline::invalidate(stage const s) {
+    for (auto i = index_of(s); i < stage_count; ++i) {
+        memo_[static_cast<size_t>(i)].valid = false;
+    }
+}
+//------------------------------------------------------------------------------
+int layout_pipeline::first_invalid_() const {
+    int i = 0;
+    while (i < stage_count && memo_[static_cast<size_t>(i)].valid) {
+        ++i;
+    }
+
+    return i;
+}
+//------------------------------------------------------------------------------
+yama::map layout_pipeline::generate(uint32_t const seed) {
+    auto const p = layout_.params();
+
+    map result {p.map_w, p.map_h};
+    generate_into(result, seed);
+    return result;
+}
+//------------------------------------------------------------------------------
+void layout_pipeline::generate_into(map& out, uint32_t const seed) {
+    if (seed != seed_) {
+        invalidate(stage::tree);
+        seed_ = seed;
+    }
+
+    auto const p      = layout_.params();
+    auto const bounds = rect_t {0, 0, p.map_w, p.map_h};
+    auto const first  = first_invalid_();
+
+    //only a map of another size (or a read only one) needs new storage
+    if (out.width() != p.map_w || out.height() != p.map_h || out.is_read_only()) {
+        out = map {p.map_w, p.map_h};
+    } else {
+        out.clear();
+    }
+
+    //resume from the map as the last memoized stage left it
+    if (first > index_of(stage::rasterize)) {
+        auto const& tiles = memo_[static_cast<size_t>(first - 1)].tiles;
+        out.write_rect<map_property::category>(bounds, tiles.data());
+    }
+
+    random_t random = first > 0
+      ? memo_[static_cast<size_t>(first - 1)].random
+      : random_t {seed};
+
+    layout_.map_ = &out;
+
+    for (int i = 0; i < stage_count; ++i) {
+        auto& report = report_[static_cast<size_t>(i)];
+        auto& memo   = memo_[static_cast<size_t>(i)];
+
+        if (i < first) {
+            report = stage_report {duration {}, true};
+            continue;
+        }
+
+        auto const s   = static_cast<stage>(i);
+        auto const beg = clock::now();
+
+        switch (s) {
+        case stage::tree      : tree_stage_(layout_, random, bounds, tree_); break;
+        case stage::rooms     : rooms_stage_(layout_, random, tree_, rooms_); break;
+        case stage::rasterize : rasterize_stage_(layout_, random, rooms_, out); break;
+        case stage::corridors : corridors_stage_(layout_, random, rooms_, out); break;
+        case stage::features  : features_stage_(layout_, random, rooms_, out, features_); break;
+        default : break;
+        }
+
+        report = stage_report {clock::now() - beg, false};
+
+        memo.valid  = true;
+        memo.random = random;
+
+        if (i >= index_of(stage::rasterize)) {
+            memo.tiles.resize(static_cast<size_t>(p.map_w) * static_cast<size_t>(p.map_h));
+            out.read_rect<map_property::category>(bounds, memo.tiles.data());
+        }
+    }
+
+    layout_.map_ = nullptr;
+}
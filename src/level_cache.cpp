@@ -0,0 +1,349 @@
+#include "pch.hpp"
+#include "level_cache.hpp"
+
+#include <boost/interprocess/sync/file_lock.hpp>
+#include <boost/interprocess/sync/scoped_lock.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <vector>
+
+using yama::level_cache;
+
+namespace {
+
+char const index_magic[4] = {'Y', 'L', 'V', 'C'};
+
+uint32_t const index_version = 1;
+
+//! hits are written to the index at the latest after this many.
+size_t const max_pending_hits = 256;
+
+struct index_entry {
+    uint64_t key;
+    uint64_t size;      //!< of the file in bytes.
+    uint64_t last_used; //!< index_header::tick when last added or hit.
+};
+
+struct index_header {
+    char     magic[4];
+    uint32_t version;
+    uint64_t tick;
+    uint64_t count;
+};
+
+static_assert(sizeof(index_entry) == 24, "");
+static_assert(sizeof(index_header) == 24, "");
+
+uint64_t file_size(std::string const& file_name) {
+    std::ifstream in {file_name, std::ios::in | std::ios::binary | std::ios::ate};
+    return in ? static_cast<uint64_t>(in.tellg()) : 0;
+}
+
+} //namespace
+
+class level_cache::impl_t {
+public:
+    impl_t(std::string Directory, uint64_t const MaxSize)
+      : directory_  {std::move(Directory)}
+      , max_size_   {MaxSize}
+      , lock_path_  {directory_ + "/level_cache.lock"}
+      , index_path_ {directory_ + "/level_cache.index"}
+    {
+        //file_lock needs an existing file
+        std::ofstream const touch {lock_path_, std::ios::out | std::ios::app};
+        file_lock_ = boost::interprocess::file_lock {lock_path_.c_str()};
+    }
+
+    ~impl_t() {
+        //recency only affects which levels are evicted; losing it is harmless
+        try {
+            if (!pending_hits_.empty()) {
+                update_index_(nullptr);
+            }
+        } catch (std::exception const&) {
+        }
+    }
+
+    //--------------------------------------------------------------------------
+    level_file_contents get(uint32_t const seed, bsp_layout::params_t const& params) {
+        auto const key  = level_key(seed, params);
+        auto const path = file_name(key);
+
+        //a missing or damaged file is simply a miss
+        try {
+            auto result = load_level_file(path);
+            record_hit_(key);
+            return result;
+        } catch (std::exception const&) {
+        }
+
+        bsp_layout layout {params};
+        random_t random {seed};
+
+        auto result = level_file_contents {layout.generate(random), layout.get_regions()};
+
+        {
+            std::lock_guard<std::mutex> lock {mutex_};
+            ++misses_;
+        }
+
+        add_(key, path, result);
+
+        return result;
+    }
+
+    //--------------------------------------------------------------------------
+    std::string file_name(uint64_t const key) const {
+        char name[32];
+        std::snprintf(name, sizeof(name), "/%016llx.level", static_cast<unsigned long long>(key));
+        return directory_ + name;
+    }
+
+    uint64_t size() const {
+        std::lock_guard<std::mutex> lock {mutex_};
+        return size_;
+    }
+
+    uint64_t hits() const {
+        std::lock_guard<std::mutex> lock {mutex_};
+        return hits_;
+    }
+
+    uint64_t misses() const {
+        std::lock_guard<std::mutex> lock {mutex_};
+        return misses_;
+    }
+private:
+    void record_hit_(uint64_t const key) {
+        bool flush = false;
+
+        {
+            std::lock_guard<std::mutex> lock {mutex_};
+            ++hits_;
+            pending_hits_.push_back(key);
+            flush = pending_hits_.size() >= max_pending_hits;
+        }
+
+        if (flush) {
+            try_update_index_(nullptr);
+        }
+    }
+
+    //! write @p level to a temporary file and rename it into place.
+    void add_(uint64_t const key, std::string const& path, level_file_contents const& level) {
+        std::string temp_path;
+
+        {
+            std::lock_guard<std::mutex> lock {mutex_};
+            temp_path = path + "." + std::to_string(nonce_()) + ".tmp";
+        }
+
+        try {
+            save_level_file(temp_path, level.level_map, level.regions);
+        } catch (std::exception const&) {
+            std::remove(temp_path.c_str());
+            return;
+        }
+
+        //another process may have added the same level; either copy will do
+        if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+            std::remove(temp_path.c_str());
+            if (!std::ifstream {path}) {
+                return;
+            }
+        }
+
+        index_entry const entry {key, file_size(path), 0};
+        try_update_index_(&entry);
+    }
+
+    //! the index only decides what is evicted; failing to update it isn't an
+    //! error for get.
+    void try_update_index_(index_entry const* const added) {
+        try {
+            update_index_(added);
+        } catch (std::exception const&) {
+        }
+    }
+
+    //! merge the pending hits and @p added into the index, then evict.
+    void update_index_(index_entry const* const added) {
+        std::lock_guard<std::mutex> lock {mutex_};
+        boost::interprocess::scoped_lock<boost::interprocess::file_lock> file_lock {file_lock_};
+
+        uint64_t tick = 0;
+        auto entries = read_index_(tick);
+
+        auto const find = [&](uint64_t const key) {
+            return std::find_if(entries.begin(), entries.end()
+              , [key](index_entry const& e) { return e.key == key; });
+        };
+
+        //a hit on a file the index lost (e.g. it was damaged) adds it back;
+        //hits on files another process has since removed are dropped
+        for (auto const key : pending_hits_) {
+            auto const it = find(key);
+            if (it != entries.end()) {
+                it->last_used = ++tick;
+            } else if (auto const size = file_size(file_name(key))) {
+                entries.push_back(index_entry {key, size, ++tick});
+            }
+        }
+
+        pending_hits_.clear();
+
+        if (added) {
+            auto const it = find(added->key);
+            if (it == entries.end()) {
+                entries.push_back(*added);
+                entries.back().last_used = ++tick;
+            } else {
+                it->size      = added->size;
+                it->last_used = ++tick;
+            }
+        }
+
+        //least recently used first; the level just added is kept regardless
+        std::sort(entries.begin(), entries.end(), [](index_entry const& a, index_entry const& b) {
+            return a.last_used < b.last_used;
+        });
+
+        auto total = std::accumulate(entries.begin(), entries.end(), uint64_t {0}
+          , [](uint64_t const sum, index_entry const& e) { return sum + e.size; });
+
+        std::vector<index_entry> kept;
+        kept.reserve(entries.size());
+
+        for (size_t i = 0; i < entries.size(); ++i) {
+            auto const& e = entries[i];
+            auto const is_newest = added && i + 1 == entries.size();
+
+            //a file in use may not be removable on some systems; retry later
+            if (total > max_size_ && !is_newest && std::remove(file_name(e.key).c_str()) == 0) {
+                total -= e.size;
+            } else {
+                kept.push_back(e);
+            }
+        }
+
+        write_index_(tick, kept);
+        size_ = total;
+    }
+
+    //! the entries of the index; empty if it's missing or damaged.
+    std::vector<index_entry> read_index_(uint64_t& tick) const {
+        std::vector<index_entry> result;
+
+        auto const size = file_size(index_path_);
+        std::ifstream in {index_path_, std::ios::in | std::ios::binary};
+
+        index_header header {};
+        in.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+        if (!in || std::memcmp(header.magic, index_magic, sizeof(header.magic)) != 0
+         || header.version != index_version
+        ) {
+            return result;
+        }
+
+        //a damaged count mustn't size the vector
+        if (size < sizeof(header) || header.count > (size - sizeof(header)) / sizeof(index_entry)) {
+            return result;
+        }
+
+        result.resize(static_cast<size_t>(header.count));
+        in.read(reinterpret_cast<char*>(result.data())
+              , static_cast<std::streamsize>(sizeof(index_entry) * result.size()));
+
+        if (!in) {
+            result.clear();
+            return result;
+        }
+
+        tick = header.tick;
+        return result;
+    }
+
+    //! replace the index; written to a temporary file first, like levels.
+    void write_index_(uint64_t const tick, std::vector<index_entry> const& entries) const {
+        auto const temp_path = index_path_ + ".tmp";
+
+        {
+            std::ofstream out {temp_path, std::ios::out | std::ios::binary | std::ios::trunc};
+
+            index_header header {};
+            std::memcpy(header.magic, index_magic, sizeof(header.magic));
+            header.version = index_version;
+            header.tick    = tick;
+            header.count   = entries.size();
+
+            out.write(reinterpret_cast<char const*>(&header), sizeof(header));
+            out.write(reinterpret_cast<char const*>(entries.data())
+                    , static_cast<std::streamsize>(sizeof(index_entry) * entries.size()));
+
+            if (!out) {
+                return;
+            }
+        }
+
+        //rename doesn't replace an existing file everywhere
+        if (std::rename(temp_path.c_str(), index_path_.c_str()) != 0) {
+            std::remove(index_path_.c_str());
+            std::rename(temp_path.c_str(), index_path_.c_str());
+        }
+    }
+
+    std::string directory_;
+    uint64_t    max_size_;
+    std::string lock_path_;
+    std::string index_path_;
+
+    boost::interprocess::file_lock file_lock_;
+
+    //! file_lock only excludes other processes.
+    mutable std::mutex mutex_;
+
+    std::mt19937_64 nonce_ {std::random_device {}()};
+
+    std::vector<uint64_t> pending_hits_;
+
+    uint64_t size_   = 0;
+    uint64_t hits_   = 0;
+    uint64_t misses_ = 0;
+};
+
+/////////////////////
+
+level_cache::level_cache(std::string Directory, uint64_t const MaxSize)
+  : impl_ {std::make_unique<impl_t>(std::move(Directory), MaxSize)}
+{
+}
+
+level_cache::~level_cache() {
+}
+
+yama::level_file_contents level_cache::get(uint32_t const seed, bsp_layout::params_t const& params) {
+    return impl_->get(seed, params);
+}
+
+std::string level_cache::file_name(uint64_t const key) const {
+    return impl_->file_name(key);
+}
+
+uint64_t level_cache::size() const {
+    return impl_->size();
+}
+
+uint64_t level_cache::hits() const {
+    return impl_->hits();
+}
+
+uint64_t level_cache::misses() const {
+    return impl_->misses();
+}
@@ -0,0 +1,432 @@
+#include "pch.hpp"
+#include "level_file.hpp"
+#include "map_journal.hpp"
+
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+#include <fstream>
+#include <stdexcept>
+#include <cstring>
+#include <type_traits>
+
+using yama::map;
+using yama::map_property;
+
+namespace {
+
+char const level_file_magic[4] = {'Y', 'L', 'V', 'L'};
+
+//! columns start on a cache line boundary.
+uint64_t const column_alignment = 64;
+
+struct column_entry {
+    uint64_t offset; //!< from the start of the file.
+    uint64_t size;   //!< in bytes.
+    int64_t  stride; //!< distance between rows in view elements.
+};
+
+struct file_header {
+    char     magic[4];
+    uint32_t version;
+    int32_t  width;
+    int32_t  height;
+    uint32_t property_count;
+    uint32_t region_count;
+    uint64_t region_offset;
+
+    column_entry columns[yama::map_property_count];
+};
+
+struct region_entry {
+    int32_t left, top, right, bottom;
+};
+
+static_assert(sizeof(column_entry) == 24, "");
+static_assert(sizeof(file_header) == 32 + 24 * yama::map_property_count, "");
+static_assert(sizeof(region_entry) == 16, "");
+
+//! the type a view's rows are made of; T for dense_view, a word for packed_view.
+template <typename View>
+using element_t = std::remove_const_t<std::remove_pointer_t<
+    decltype(std::declval<View const&>().row(0))>>;
+
+//! the smallest stride able to hold a row of the view.
+template <typename T>
+int64_t min_stride(yama::dense_view<T> const*, int const width) {
+    return width;
+}
+
+template <typename T, int Bits>
+int64_t min_stride(yama::packed_view<T, Bits> const*, int const width) {
+    using view_t = yama::packed_view<T, Bits>;
+    return (width + view_t::values_per_word - 1) / view_t::values_per_word;
+}
+
+[[noreturn]] void invalid_file(std::string const& file_name, char const* const reason) {
+    throw std::runtime_error {"invalid level file \"" + file_name + "\": " + reason};
+}
+
+//------------------------------------------------------------------------------
+template <typename View>
+void write_column(std::ofstream& out, View const& v, column_entry& entry) {
+    using T = element_t<View>;
+
+    auto const pos     = static_cast<uint64_t>(out.tellp());
+    auto const padding = (column_alignment - pos % column_alignment) % column_alignment;
+
+    char const zeros[column_alignment] = {};
+    out.write(zeros, static_cast<std::streamsize>(padding));
+
+    entry.offset = pos + padding;
+    entry.stride = v.stride();
+    entry.size   = sizeof(T) * static_cast<uint64_t>(v.stride()) * static_cast<uint64_t>(v.height());
+
+    out.write(reinterpret_cast<char const*>(v.row(0)), static_cast<std::streamsize>(entry.size));
+}
+
+template <int... Is>
+void write_columns(std::ofstream& out, map const& m, file_header& header, std::integer_sequence<int, Is...>) {
+    auto const expand = {(write_column(out, m.view<static_cast<map_property>(Is)>(), header.columns[Is]), 0)...};
+    (void)expand;
+}
+
+//------------------------------------------------------------------------------
+//! the mapped file; shared by the map for as long as it exists.
+struct mapped_file {
+    explicit mapped_file(std::string const& file_name)
+      : file   {file_name.c_str(), boost::interprocess::read_only}
+      , region {file, boost::interprocess::read_only}
+    {
+    }
+
+    char const* data() const { return static_cast<char const*>(region.get_address()); }
+    uint64_t    size() const { return region.get_size(); }
+
+    boost::interprocess::file_mapping  file;
+    boost::interprocess::mapped_region region;
+};
+
+template <typename View>
+View read_column(std::string const& file_name, mapped_file const& file, file_header const& header, int const i) {
+    using T = element_t<View>;
+
+    auto const& entry = header.columns[i];
+
+    if (entry.offset % alignof(T) != 0) {
+        invalid_file(file_name, "misaligned column");
+    }
+
+    if (entry.stride < min_stride(static_cast<View const*>(nullptr), header.width)) {
+        invalid_file(file_name, "bad column stride");
+    }
+
+    if (entry.size != sizeof(T) * static_cast<uint64_t>(entry.stride) * static_cast<uint64_t>(header.height)
+     || entry.offset > file.size() || entry.size > file.size() - entry.offset
+    ) {
+        invalid_file(file_name, "bad column size");
+    }
+
+    auto const data = reinterpret_cast<T const*>(file.data() + entry.offset);
+    return View {data, header.width, header.height, static_cast<ptrdiff_t>(entry.stride)};
+}
+
+template <int... Is>
+map::views_t read_columns(
+    std::string const& file_name
+  , mapped_file const& file
+  , file_header const& header
+  , std::integer_sequence<int, Is...>
+) {
+    return map::views_t {
+        read_column<map::view_t<static_cast<map_property>(Is)>>(file_name, file, header, Is)...
+    };
+}
+
+//------------------------------------------------------------------------------
+char const level_delta_magic[4] = {'Y', 'L', 'V', 'D'};
+
+//! call function(value) for every scalar in @p p, in file order.
+template <typename F>
+void for_each_param(yama::bsp_layout::params_t& p, F&& function) {
+    function(p.map_w);
+    function(p.map_h);
+    function(p.room_w_range.lower);
+    function(p.room_w_range.upper);
+    function(p.room_h_range.lower);
+    function(p.room_h_range.upper);
+    function(p.room_size_weight);
+    function(p.room_size_variance);
+    function(p.border_size);
+    function(p.region_w_range.lower);
+    function(p.region_w_range.upper);
+    function(p.region_h_range.lower);
+    function(p.region_h_range.upper);
+    function(p.corridor_segment_length_range.lower);
+    function(p.corridor_segment_length_range.upper);
+    function(p.room_generation_chance);
+    function(p.region_split_chance);
+    function(p.split_aspect);
+    function(p.split_limit_aspect);
+    function(p.corridor_randomness);
+    function(p.route_corridors);
+    function(p.subtree_area);
+}
+
+//! true if @p value is one a param of type T can hold.
+template <typename T>
+bool is_valid_param(T const*, T const) {
+    return true;
+}
+
+template <typename T, typename Check, yama::failure_policy Policy>
+bool is_valid_param(yama::checked_value<T, Check, Policy> const*, T const value) {
+    return Check::check(value);
+}
+
+//! read a param as written by save_level_delta; false, leaving @p param
+//! unchanged, if the value read isn't one the param can hold.
+template <typename T>
+bool read_param(std::istream& in, T& param) {
+    yama::get_value_type_t<T> value {};
+    in.read(reinterpret_cast<char*>(&value), sizeof(value));
+
+    if (!in || !is_valid_param(static_cast<T const*>(nullptr), value)) {
+        return false;
+    }
+
+    param = value;
+    return true;
+}
+
+//! bools are read as a byte; anything but 0 or 1 isn't a bool.
+bool read_param(std::istream& in, bool& param) {
+    uint8_t value = 0;
+    in.read(reinterpret_cast<char*>(&value), sizeof(value));
+
+    if (!in || value > 1) {
+        return false;
+    }
+
+    param = value != 0;
+    return true;
+}
+
+template <typename T>
+bool is_ordered(yama::closed_integral_interval<T> const& i) {
+    return i.lower <= i.upper;
+}
+
+} //namespace
+
+void yama::save_level_file(
+    std::string         const& file_name
+  , map                 const& m
+  , std::vector<rect_t> const& regions
+) {
+    std::ofstream out {file_name, std::ios::out | std::ios::binary | std::ios::trunc};
+    if (!out) {
+        throw std::runtime_error {"couldn't open \"" + file_name + "\" for writing"};
+    }
+
+    file_header header {};
+    std::memcpy(header.magic, level_file_magic, sizeof(header.magic));
+    header.version        = level_file_version;
+    header.width          = m.width();
+    header.height         = m.height();
+    header.property_count = map_property_count;
+    header.region_count   = static_cast<uint32_t>(regions.size());
+
+    //the header is written again once the offsets are known
+    out.write(reinterpret_cast<char const*>(&header), sizeof(header));
+
+    write_columns(out, m, header, std::make_integer_sequence<int, map_property_count> {});
+
+    header.region_offset = static_cast<uint64_t>(out.tellp());
+    for (auto const& r : regions) {
+        region_entry const entry {r.left, r.top, r.right, r.bottom};
+        out.write(reinterpret_cast<char const*>(&entry), sizeof(entry));
+    }
+
+    out.seekp(0);
+    out.write(reinterpret_cast<char const*>(&header), sizeof(header));
+
+    if (!out) {
+        throw std::runtime_error {"couldn't write \"" + file_name + "\""};
+    }
+}
+
+yama::level_file_contents yama::load_level_file(std::string const& file_name) {
+    auto const file = std::make_shared<mapped_file>(file_name);
+
+    file_header header;
+    if (file->size() < sizeof(header)) {
+        invalid_file(file_name, "truncated header");
+    }
+
+    std::memcpy(&header, file->data(), sizeof(header));
+
+    if (std::memcmp(header.magic, level_file_magic, sizeof(header.magic)) != 0) {
+        invalid_file(file_name, "bad magic");
+    }
+
+    if (header.version != level_file_version) {
+        invalid_file(file_name, "unsupported version");
+    }
+
+    if (header.property_count != map_property_count) {
+        invalid_file(file_name, "wrong property count");
+    }
+
+    if (header.width < map_min_size || header.height < map_min_size) {
+        invalid_file(file_name, "bad size");
+    }
+
+    auto const regions_size = sizeof(region_entry) * static_cast<uint64_t>(header.region_count);
+    if (header.region_offset > file->size() || regions_size > file->size() - header.region_offset) {
+        invalid_file(file_name, "truncated region list");
+    }
+
+    auto views = read_columns(file_name, *file, header, std::make_integer_sequence<int, map_property_count> {});
+
+    std::vector<rect_t> regions;
+    regions.reserve(header.region_count);
+
+    for (uint32_t i = 0; i < header.region_count; ++i) {
+        region_entry entry;
+        std::memcpy(&entry, file->data() + header.region_offset + i * sizeof(entry), sizeof(entry));
+        regions.emplace_back(entry.left, entry.top, entry.right, entry.bottom);
+    }
+
+    return level_file_contents {map {std::move(views), file}, std::move(regions)};
+}
+
+void yama::save_level_delta(
+    std::string          const& file_name
+  , uint32_t             const  seed
+  , bsp_layout::params_t const& params
+  , map_journal          const& journal
+) {
+    std::ofstream out {file_name, std::ios::out | std::ios::binary | std::ios::trunc};
+    if (!out) {
+        throw std::runtime_error {"couldn't open \"" + file_name + "\" for writing"};
+    }
+
+    out.write(level_delta_magic, sizeof(level_delta_magic));
+    out.write(reinterpret_cast<char const*>(&level_delta_version), sizeof(level_delta_version));
+
+    //the level can only be regenerated by the same generator and engine
+    uint32_t const generator = bsp_layout::generator_version;
+    uint32_t const engine    = random_engine_id();
+    out.write(reinterpret_cast<char const*>(&generator), sizeof(generator));
+    out.write(reinterpret_cast<char const*>(&engine), sizeof(engine));
+
+    out.write(reinterpret_cast<char const*>(&seed), sizeof(seed));
+
+    auto p = params;
+    for_each_param(p, [&](auto const& param) {
+        get_value_type_t<std::decay_t<decltype(param)>> const value = param;
+        out.write(reinterpret_cast<char const*>(&value), sizeof(value));
+    });
+
+    journal.write(out);
+
+    if (!out) {
+        throw std::runtime_error {"couldn't write \"" + file_name + "\""};
+    }
+}
+
+yama::map yama::load_level_delta(std::string const& file_name) {
+    std::ifstream in {file_name, std::ios::in | std::ios::binary};
+    if (!in) {
+        throw std::runtime_error {"couldn't open \"" + file_name + "\""};
+    }
+
+    char     magic[4]  = {};
+    uint32_t version   = 0;
+    uint32_t generator = 0;
+    uint32_t engine    = 0;
+    uint32_t seed      = 0;
+
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&version), sizeof(version));
+    in.read(reinterpret_cast<char*>(&generator), sizeof(generator));
+    in.read(reinterpret_cast<char*>(&engine), sizeof(engine));
+    in.read(reinterpret_cast<char*>(&seed), sizeof(seed));
+
+    if (!in || std::memcmp(magic, level_delta_magic, sizeof(magic)) != 0) {
+        invalid_file(file_name, "bad magic");
+    }
+
+    if (version != level_delta_version) {
+        invalid_file(file_name, "unsupported version");
+    }
+
+    if (generator != bsp_layout::generator_version) {
+        invalid_file(file_name, "saved by another version of the level generator");
+    }
+
+    if (engine != random_engine_id()) {
+        invalid_file(file_name, "saved with another random engine");
+    }
+
+    //checked before assigning; a bad value would otherwise abort
+    bsp_layout::params_t params;
+    bool params_ok = true;
+    for_each_param(params, [&](auto& param) {
+        params_ok = params_ok && read_param(in, param);
+    });
+
+    if (!in) {
+        invalid_file(file_name, "truncated");
+    }
+
+    if (!params_ok
+     || !is_ordered(params.room_w_range)   || !is_ordered(params.room_h_range)
+     || !is_ordered(params.region_w_range) || !is_ordered(params.region_h_range)
+     || !is_ordered(params.corridor_segment_length_range)
+    ) {
+        invalid_file(file_name, "bad generator parameters");
+    }
+
+    map_journal journal;
+    if (!journal.read(in, params.map_w, params.map_h)) {
+        invalid_file(file_name, "truncated or malformed changes");
+    }
+
+    random_t random {seed};
+    auto result = bsp_layout {params}.generate(random);
+
+    result.set_journaling(true);
+    if (!journal.replay(result)) {
+        invalid_file(file_name, "changes don't match the generated level");
+    }
+
+    return result;
+}
+
+uint64_t yama::level_key(uint32_t const seed, bsp_layout::params_t const& params) {
+    //FNV-1a over the values in delta file order
+    uint64_t hash = 14695981039346656037ull;
+
+    auto const add = [&](auto const value) {
+        unsigned char bytes[sizeof(value)];
+        std::memcpy(bytes, &value, sizeof(value));
+
+        for (auto const b : bytes) {
+            hash = (hash ^ b) * 1099511628211ull;
+        }
+    };
+
+    add(bsp_layout::generator_version);
+    add(random_engine_id());
+    add(seed);
+
+    auto p = params;
+    for_each_param(p, [&](auto const& param) {
+        get_value_type_t<std::decay_t<decltype(param)>> const value = param;
+        add(value);
+    });
+
+    return hash;
+}
@@ -0,0 +1,183 @@
+#include "pch.hpp"
+#include "level_metrics.hpp"
+
+#include <algorithm>
+
+using yama::level_analyzer;
+using yama::level_metrics;
+using yama::grid_position_t;
+using yama::tile_category;
+using yama::map_property;
+
+namespace {
+
+grid_position_t const no_position {-1, -1};
+
+//! the walkable orthogonal neighbors of (x, y), off-map tiles excluded.
+template <typename View>
+int walkable_neighbors(View const& v, int const x, int const y) {
+    auto const walkable = [&](int const xi, int const yi) {
+        return v.is_valid_index(xi, yi) && yama::is_walkable(v(xi, yi)) ? 1 : 0;
+    };
+
+    return walkable(x - 1, y) + walkable(x + 1, y) + walkable(x, y - 1) + walkable(x, y + 1);
+}
+
+} //namespace
+
+level_metrics level_analyzer::analyze(map const& m) {
+    level_metrics result;
+
+    auto const w = m.width();
+    auto const h = m.height();
+
+    for (auto& row : rows_) {
+        row.assign(static_cast<size_t>(w), tile_category::empty);
+    }
+
+    dead_ends_.clear();
+
+    grid_position_t stairs[2] = {no_position, no_position};
+    int stair_count = 0;
+
+    //rows y - 1, y and y + 1; rows off the map are empty
+    auto above = rows_[0].data();
+    auto row   = rows_[1].data();
+    auto below = rows_[2].data();
+
+    m.read_row<map_property::category>(0, row);
+
+    for (int y = 0; y < h; ++y) {
+        if (y + 1 < h) {
+            m.read_row<map_property::category>(y + 1, below);
+        } else {
+            std::fill(below, below + w, tile_category::empty);
+        }
+
+        for (int x = 0; x < w; ++x) {
+            auto const c = row[x];
+
+            if (c == tile_category::stair) {
+                if (stair_count < 2) {
+                    stairs[stair_count] = grid_position_t {x, y};
+                }
+                ++stair_count;
+            } else if (c == tile_category::corridor) {
+                auto const neighbors = (x > 0     && is_walkable(row[x - 1]) ? 1 : 0)
+                                     + (x + 1 < w && is_walkable(row[x + 1]) ? 1 : 0)
+                                     + (is_walkable(above[x]) ? 1 : 0)
+                                     + (is_walkable(below[x]) ? 1 : 0);
+
+                if (neighbors <= 1) {
+                    dead_ends_.push_back(grid_position_t {x, y});
+                }
+            }
+        }
+
+        //rotate; the old above becomes the next below
+        std::swap(above, row);
+        std::swap(row, below);
+    }
+
+    for (auto const p : dead_ends_) {
+        result.longest_dead_end = std::max(result.longest_dead_end, dead_end_length_(m, p));
+    }
+
+    if (stair_count == 2) {
+        result.stair_distance = distance_(m, stairs[0], stairs[1]);
+    }
+
+    return result;
+}
+
+int level_analyzer::dead_end_length_(map const& m, grid_position_t p) const {
+    auto const v = m.view<map_property::category>();
+
+    grid_position_t const steps[] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+
+    auto prev   = p;
+    int  result = 1;
+
+    for (;;) {
+        //the one way on that isn't back
+        auto next = no_position;
+        for (auto const d : steps) {
+            auto const q = grid_position_t {p.x + d.x, p.y + d.y};
+            if (q != prev && v.is_valid_index(q.x, q.y) && is_walkable(v(q.x, q.y))) {
+                next = q;
+                break;
+            }
+        }
+
+        if (next == no_position
+         || v(next.x, next.y) != tile_category::corridor
+         || walkable_neighbors(v, next.x, next.y) != 2
+        ) {
+            return result;
+        }
+
+        prev = p;
+        p    = next;
+        ++result;
+    }
+}
+
+int level_analyzer::distance_(map const& m, grid_position_t const from, grid_position_t const to) {
+    auto const v = m.view<map_property::category>();
+
+    auto const w = m.width();
+    auto const h = m.height();
+
+    auto const index_of = [w](int const x, int const y) {
+        return static_cast<uint32_t>(x) + static_cast<uint32_t>(y) * static_cast<uint32_t>(w);
+    };
+
+    visited_.assign((static_cast<size_t>(w) * static_cast<size_t>(h) + 63) / 64, 0);
+
+    //true the first time for each tile
+    auto const visit = [&](uint32_t const i) {
+        auto& word = visited_[i >> 6];
+        auto const bit = uint64_t {1} << (i & 63);
+        auto const result = (word & bit) == 0;
+        word |= bit;
+        return result;
+    };
+
+    auto const target = index_of(to.x, to.y);
+
+    frontier_.clear();
+    frontier_.push_back(index_of(from.x, from.y));
+    visit(frontier_.back());
+
+    //one breadth first layer per step
+    for (int distance = 0; !frontier_.empty(); ++distance) {
+        next_.clear();
+
+        for (auto const i : frontier_) {
+            if (i == target) {
+                return distance;
+            }
+
+            auto const x = static_cast<int>(i % static_cast<uint32_t>(w));
+            auto const y = static_cast<int>(i / static_cast<uint32_t>(w));
+
+            auto const step = [&](int const xi, int const yi) {
+                if (xi >= 0 && xi < w && yi >= 0 && yi < h && is_walkable(v(xi, yi))) {
+                    auto const j = index_of(xi, yi);
+                    if (visit(j)) {
+                        next_.push_back(j);
+                    }
+                }
+            };
+
+            step(x - 1, y);
+            step(x + 1, y);
+            step(x, y - 1);
+            step(x, y + 1);
+        }
+
+        std::swap(frontier_, next_);
+    }
+
+    return -1;
+}
@@ -1,58 +1,232 @@
 #include "pch.hpp"
 #include "map.hpp"
+#include "map_journal.hpp"
 
 #include "grid.hpp"
+#include "packed_grid.hpp"
+
+#include <tuple>
 
 using yama::map;
+using yama::map_property;
+using views_t = yama::map::views_t;
+
+namespace {
+
+////////////////////////////////////////////////////////////////////////////////
+//! The column (storage) type matching a view type.
+////////////////////////////////////////////////////////////////////////////////
+template <typename View> struct column_for_view;
+
+template <typename T>
+struct column_for_view<yama::dense_view<T>> {
+    using type = yama::grid<T>;
+};
+
+template <typename T, int Bits>
+struct column_for_view<yama::packed_view<T, Bits>> {
+    using type = yama::packed_grid<T, Bits>;
+};
+
+template <map_property P>
+using column_t = typename column_for_view<map::view_t<P>>::type;
+
+template <typename Seq> struct make_columns;
+
+template <int... Is>
+struct make_columns<std::integer_sequence<int, Is...>> {
+    using type = std::tuple<column_t<static_cast<map_property>(Is)>...>;
+};
+
+//! std::tuple of every property column.
+using columns_t = typename make_columns<
+    std::make_integer_sequence<int, yama::map_property_count>
+>::type;
+
+//------------------------------------------------------------------------------
+template <typename T, typename L>
+inline void column_set(yama::grid<T, L>& column, int const x, int const y, T const value) {
+    column(x, y) = value;
+}
+
+template <typename T, int B>
+inline void column_set(yama::packed_grid<T, B>& column, int const x, int const y, T const value) {
+    column.set(x, y, value);
+}
+
+template <typename T>
+inline void column_fill_row(yama::grid<T>& column, int const y, int const x0, int const x1, T const value) {
+    auto const row = column.row(y);
+    std::fill(row + x0, row + x1, value);
+}
+
+template <typename T, int B>
+inline void column_fill_row(yama::packed_grid<T, B>& column, int const y, int const x0, int const x1, T const value) {
+    column.fill_row(y, x0, x1, value);
+}
+
+template <typename T>
+inline void column_write_row(yama::grid<T>& column, int const y, int const x0, int const x1, T const* const in) {
+    std::copy(in, in + (x1 - x0), column.row(y) + x0);
+}
+
+template <typename T, int B>
+inline void column_write_row(yama::packed_grid<T, B>& column, int const y, int const x0, int const x1, T const* const in) {
+    column.encode_row(y, x0, x1, in);
+}
+
+//! record the changes to [x0, x1) of row y of @p v; the new values are from @p in.
+template <map_property P, typename View, typename F>
+void journal_row(yama::map_journal& journal, View const& v, int const y, int const x0, int const x1, F&& in) {
+    for (auto x = x0; x < x1; ++x) {
+        journal.record<P>(x, y, v(x, y), in(x - x0));
+    }
+}
+
+template <int... Is>
+void fill_defaults(map& m, std::integer_sequence<int, Is...>) {
+    yama::rect_t const r {0, 0, m.width(), m.height()};
+    auto const expand = {(m.fill_rect<static_cast<map_property>(Is)>(r, map::mapping_t<static_cast<map_property>(Is)> {}), 0)...};
+    (void)expand;
+}
+
+inline bool contains(map const& m, yama::rect_t const r) {
+    return r.left >= 0 && r.top >= 0 && r.left <= r.right && r.top <= r.bottom
+        && r.right <= m.width() && r.bottom <= m.height();
+}
+
+template <int... Is>
+inline columns_t make_columns_of(int const w, int const h, std::integer_sequence<int, Is...>) {
+    return columns_t {column_t<static_cast<map_property>(Is)> {w, h}...};
+}
+
+} //namespace
 
 class map::impl_t {
 public:
     impl_t(int const Width, int const Height)
-      : category_ {Width, Height}
+      : columns_ {std::make_unique<columns_t>(
+            make_columns_of(Width, Height, std::make_integer_sequence<int, map_property_count> {}))}
+      , views_   {views_of_(*columns_, std::make_integer_sequence<int, map_property_count> {})}
+      , dirty_   {Width, Height}
+    {
+    }
+
+    impl_t(views_t Views, std::shared_ptr<void const> Storage)
+      : columns_ {}
+      , views_   {std::move(Views)}
+      , storage_ {std::move(Storage)}
+      , dirty_   {std::get<0>(views_).width(), std::get<0>(views_).height()}
     {
     }
 
     void clear() {
-        category_.clear();
+        BK_ASSERT(!is_read_only());
+        dirty_.mark_all();
+        clear_(std::make_integer_sequence<int, map_property_count> {});
+    }
+
+    bool is_read_only() const {
+        return !columns_;
+    }
+
+    //! the journal if journaling, otherwise null.
+    yama::map_journal* active_journal() {
+        return journaling_ ? &journal_ : nullptr;
+    }
+
+    void set_journaling(bool const enabled) {
+        journaling_ = enabled;
+    }
+
+    bool is_journaling() const {
+        return journaling_;
+    }
+
+    yama::map_journal& journal() {
+        return journal_;
+    }
+
+    yama::dirty_tracker& dirty() {
+        return dirty_;
+    }
+
+    yama::dirty_tracker const& dirty() const {
+        return dirty_;
+    }
+
+    views_t const& views() const {
+        return views_;
     }
 
-    tile_category get_category(int x, int y) const {
-        return category_(x, y);
+    template <map_property P>
+    map::view_t<P> const& view() const {
+        return std::get<static_cast<size_t>(P)>(views_);
     }
 
-    void set_category(int x, int y, tile_category const value) {
-        category_(x, y) = value;
+    template <map_property P>
+    column_t<P>& column() {
+        BK_ASSERT(!is_read_only());
+        return std::get<static_cast<size_t>(P)>(*columns_);
     }
 
     bool is_valid_position(int x, int y) const {
-        return category_.is_valid_index(x, y);
+        return view<map_property::category>().is_valid_index(x, y);
     }
 
     int width() const {
-        return category_.width();
+        return view<map_property::category>().width();
     }
 
     int height() const {
-        return category_.height();
+        return view<map_property::category>().height();
     }
 private:
-    grid<tile_category> category_;
+    template <int... Is>
+    void clear_(std::integer_sequence<int, Is...>) {
+        auto const expand = {(std::get<Is>(*columns_).clear(), 0)...};
+        (void)expand;
+    }
+
+    //! column storage never moves, so views of it stay valid.
+    template <int... Is>
+    static views_t views_of_(columns_t const& columns, std::integer_sequence<int, Is...>) {
+        return views_t {std::get<Is>(columns).view()...};
+    }
+
+    std::unique_ptr<columns_t>  columns_; //!< null for read-only maps.
+    views_t                     views_;   //!< views of either columns_ or storage_.
+    std::shared_ptr<void const> storage_; //!< external storage for read-only maps.
+
+    yama::map_journal journal_;
+    bool              journaling_ = false;
+
+    yama::dirty_tracker dirty_;
 };
 
 /////////////////////
 
 map::map(map&& other)
-  : impl_ {std::move(other.impl_)}
+  : impl_  {std::move(other.impl_)}
+  , views_ {other.views_}
 {
 }
 
 map& map::operator=(map&& rhs) {
     std::swap(impl_, rhs.impl_);
+    std::swap(views_, rhs.views_);
     return *this;
 }
 
 map::map(yama::map_size const Width, yama::map_size const Height)
-  : impl_ {std::make_unique<impl_t>(Width, Height)}
+  : impl_  {std::make_unique<impl_t>(Width, Height)}
+  , views_ {impl_->views()}
+{
+}
+
+map::map(views_t views, std::shared_ptr<void const> storage)
+  : impl_  {std::make_unique<impl_t>(std::move(views), std::move(storage))}
+  , views_ {impl_->views()}
 {
 }
 
@@ -60,15 +234,116 @@ map::~map() {
 }
 
 void map::clear() {
-    impl_->clear();
+    if (impl_->active_journal()) {
+        fill_defaults(*this, std::make_integer_sequence<int, map_property_count> {});
+    } else {
+        impl_->clear();
+    }
+}
+
+bool map::is_read_only() const {
+    return impl_->is_read_only();
+}
+
+void map::set_journaling(bool const enabled) {
+    impl_->set_journaling(enabled);
 }
 
-yama::tile_category map::get_category_(int const x, int const y) const {
-    return impl_->get_category(x, y);
+bool map::is_journaling() const {
+    return impl_->is_journaling();
 }
 
-void map::set_category_(int x, int y, yama::tile_category value) {
-    impl_->set_category(x, y, value);
+yama::map_journal const& map::journal() const {
+    return impl_->journal();
+}
+
+yama::map_journal& map::journal() {
+    return impl_->journal();
+}
+
+map::epoch_t map::epoch() const {
+    return impl_->dirty().epoch();
+}
+
+map::epoch_t map::next_epoch() {
+    return impl_->dirty().next_epoch();
+}
+
+std::vector<yama::rect_t> map::changed_since(epoch_t const since) const {
+    return impl_->dirty().changed_since(since);
+}
+
+template <map_property P>
+void map::set(int const x, int const y, mapping_t<P> const value) {
+    auto& column = impl_->column<P>();
+
+    if (auto const journal = impl_->active_journal()) {
+        journal->record<P>(x, y, get<P>(x, y), value);
+    }
+
+    impl_->dirty().mark(x, y);
+    column_set(column, x, y, value);
+}
+
+template <map_property P>
+void map::read_row(int const y, mapping_t<P>* const out) const {
+    impl_->view<P>().read_row(y, 0, width(), out);
+}
+
+template <map_property P>
+map::view_t<P> map::view() const {
+    return impl_->view<P>();
+}
+
+template <map_property P>
+void map::read_rect(rect_t const r, mapping_t<P>* out) const {
+    BK_ASSERT(contains(*this, r));
+
+    auto const& v = impl_->view<P>();
+    auto const w = r.width();
+
+    for (auto y = r.top; y < r.bottom; ++y, out += w) {
+        v.read_row(y, r.left, r.right, out);
+    }
+}
+
+template <map_property P>
+void map::write_rect(rect_t const r, mapping_t<P> const* in) {
+    BK_ASSERT(contains(*this, r));
+
+    auto&      column  = impl_->column<P>();
+    auto const w       = r.width();
+    auto const journal = impl_->active_journal();
+
+    impl_->dirty().mark(r);
+
+    for (auto y = r.top; y < r.bottom; ++y, in += w) {
+        if (journal) {
+            journal_row<P>(*journal, impl_->view<P>(), y, r.left, r.right
+              , [&](int const i) { return in[i]; });
+        }
+
+        column_write_row(column, y, r.left, r.right, in);
+    }
+}
+
+template <map_property P>
+void map::fill_rect(rect_t const r, mapping_t<P> const value) {
+    BK_ASSERT(contains(*this, r));
+
+    auto&      column  = impl_->column<P>();
+    auto const journal = impl_->active_journal();
+
+    impl_->dirty().mark(r);
+
+    for (auto y = r.top; y < r.bottom; ++y) {
+        if (journal) {
+            journal_row<P>(*journal, impl_->view<P>(), y, r.left, r.right
+              , [&](int) { return value; });
+        }
+
+        column_fill_row(column, y, r.left, r.right, value);
+    }
 }
 
 bool map::is_valid_position(int x, int y) const {
@@ -82,3 +357,20 @@ int map::width() const {
 int map::height() const {
     return impl_->height();
 }
+
+//==============================================================================
+//! Explicit instantiations; one line per property.
+//==============================================================================
+#define YAMA_MAP_INSTANTIATE(P) \
+template void map::set<P>(int, int, map::mapping_t<P>); \
+template void map::read_row<P>(int, map::mapping_t<P>*) const; \
+template map::view_t<P> map::view<P>() const; \
+template void map::read_rect<P>(yama::rect_t, map::mapping_t<P>*) const; \
+template void map::write_rect<P>(yama::rect_t, map::mapping_t<P> const*); \
+template void map::fill_rect<P>(yama::rect_t, map::mapping_t<P>)
+
+YAMA_MAP_INSTANTIATE(map_property::category);
+YAMA_MAP_INSTANTIATE(map_property::room_id);
+YAMA_MAP_INSTANTIATE(map_property::texture_id);
+
+#undef YAMA_MAP_INSTANTIATE
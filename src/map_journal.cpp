@@ -0,0 +1,152 @@
+#include "pch.hpp"
+#include "map_journal.hpp"
+
+#include <array>
+#include <istream>
+#include <limits>
+#include <ostream>
+
+using yama::map;
+using yama::map_delta;
+using yama::map_journal;
+using yama::map_property;
+
+namespace {
+
+template <map_property P>
+bool apply_delta(map& m, map_delta const& d) {
+    using T = map::mapping_t<P>;
+
+    auto const old_value = static_cast<T>(d.old_value);
+    auto const new_value = static_cast<T>(d.new_value);
+
+    for (auto x = d.x; x < d.x + d.count; ++x) {
+        if (m.get<P>(x, d.y) != old_value) {
+            return false;
+        }
+
+        m.set<P>(x, d.y, new_value);
+    }
+
+    return true;
+}
+
+using apply_delta_t = bool (*)(map&, map_delta const&);
+
+template <int... Is>
+std::array<apply_delta_t, yama::map_property_count>
+make_apply_table(std::integer_sequence<int, Is...>) {
+    return {{&apply_delta<static_cast<map_property>(Is)>...}};
+}
+
+//! apply_delta for each property, indexed by property.
+std::array<apply_delta_t, yama::map_property_count> const apply_table =
+    make_apply_table(std::make_integer_sequence<int, yama::map_property_count> {});
+
+//! the largest value the storage of a column can hold.
+template <typename T>
+uint32_t max_stored_value(yama::dense_view<T> const*) {
+    return std::numeric_limits<T>::max();
+}
+
+template <typename T, int Bits>
+uint32_t max_stored_value(yama::packed_view<T, Bits> const*) {
+    return static_cast<uint32_t>(yama::packed_view<T, Bits>::value_mask);
+}
+
+template <int... Is>
+std::array<uint32_t, yama::map_property_count>
+make_max_value_table(std::integer_sequence<int, Is...>) {
+    return {{max_stored_value(static_cast<map::view_t<static_cast<map_property>(Is)> const*>(nullptr))...}};
+}
+
+//! max_stored_value for each property, indexed by property.
+std::array<uint32_t, yama::map_property_count> const max_value_table =
+    make_max_value_table(std::make_integer_sequence<int, yama::map_property_count> {});
+
+//! true if the run of @p d lies within a @p width by @p height map.
+bool is_in_bounds(map_delta const& d, int const width, int const height) {
+    //count <= width - x rather than x + count <= width, which can overflow
+    return d.x >= 0 && d.y >= 0 && d.count > 0
+        && d.x < width && d.y < height && d.count <= width - d.x;
+}
+
+//! a delta as written; fixed size, no padding.
+#pragma pack(push, 1)
+struct delta_record {
+    uint8_t  property;
+    int32_t  x;
+    int32_t  y;
+    int32_t  count;
+    uint32_t old_value;
+    uint32_t new_value;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(delta_record) == 21, "");
+
+} //namespace
+
+bool yama::operator==(map_delta const& a, map_delta const& b) {
+    return a.x == b.x && a.y == b.y && a.count == b.count && a.property == b.property
+        && a.old_value == b.old_value && a.new_value == b.new_value;
+}
+
+bool map_journal::replay(map& m) const {
+    for (auto const& d : deltas_) {
+        if (!is_in_bounds(d, m.width(), m.height())) {
+            return false;
+        }
+
+        if (!apply_table[static_cast<size_t>(d.property)](m, d)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void map_journal::write(std::ostream& out) const {
+    auto const count = static_cast<uint32_t>(deltas_.size());
+    out.write(reinterpret_cast<char const*>(&count), sizeof(count));
+
+    for (auto const& d : deltas_) {
+        delta_record const r {
+            static_cast<uint8_t>(d.property), d.x, d.y, d.count, d.old_value, d.new_value
+        };
+        out.write(reinterpret_cast<char const*>(&r), sizeof(r));
+    }
+}
+
+bool map_journal::read(std::istream& in, int const width, int const height) {
+    deltas_.clear();
+
+    uint32_t count = 0;
+    if (!in.read(reinterpret_cast<char*>(&count), sizeof(count))) {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < count; ++i) {
+        delta_record r;
+        if (!in.read(reinterpret_cast<char*>(&r), sizeof(r))
+         || r.property >= map_property_count
+        ) {
+            deltas_.clear();
+            return false;
+        }
+
+        map_delta const d {
+            r.x, r.y, r.count, static_cast<map_property>(r.property), r.old_value, r.new_value
+        };
+
+        auto const max_value = max_value_table[r.property];
+        if (!is_in_bounds(d, width, height) || d.old_value > max_value || d.new_value > max_value) {
+            deltas_.clear();
+            return false;
+        }
+
+        deltas_.push_back(d);
+    }
+
+    return true;
+}
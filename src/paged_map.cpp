@@ -0,0 +1,480 @@
+#include "pch.hpp"
+#include "paged_map.hpp"
+
+#include "grid.hpp"
+
+#include <algorithm>
+#include <tuple>
+#include <utility>
+#include <vector>
+#include <fstream>
+#include <stdexcept>
+#include <cstdio>
+
+using yama::paged_map;
+using yama::map_property;
+
+namespace {
+
+template <map_property P>
+using chunk_column_t = yama::grid<paged_map::mapping_t<P>>;
+
+template <typename Seq> struct make_chunk_columns;
+
+template <int... Is>
+struct make_chunk_columns<std::integer_sequence<int, Is...>> {
+    using type = std::tuple<chunk_column_t<static_cast<map_property>(Is)>...>;
+};
+
+//! std::tuple of every property column of a chunk.
+using chunk_columns_t = typename make_chunk_columns<
+    std::make_integer_sequence<int, yama::map_property_count>
+>::type;
+
+template <int... Is>
+inline chunk_columns_t make_chunk_columns_of(std::integer_sequence<int, Is...>) {
+    return chunk_columns_t {
+        chunk_column_t<static_cast<map_property>(Is)> {paged_map::chunk_size, paged_map::chunk_size}...
+    };
+}
+
+template <int... Is>
+inline size_t chunk_bytes_of(std::integer_sequence<int, Is...>) {
+    size_t result = 0;
+    auto const expand = {(result += sizeof(paged_map::mapping_t<static_cast<map_property>(Is)>), 0)...};
+    (void)expand;
+
+    return result * paged_map::chunk_size * paged_map::chunk_size;
+}
+
+//! raw bytes of a chunk column; columns are flat so the whole grid is contiguous.
+template <typename T>
+inline char* column_bytes(yama::grid<T>& column) {
+    return reinterpret_cast<char*>(column.row(0));
+}
+
+template <typename T>
+inline size_t column_size(yama::grid<T> const&) {
+    return sizeof(T) * paged_map::chunk_size * paged_map::chunk_size;
+}
+
+[[noreturn]] void swap_file_error(std::string const& file_name, char const* const reason) {
+    throw std::runtime_error {"swap file \"" + file_name + "\": " + reason};
+}
+
+} //namespace
+
+class paged_map::impl_t {
+public:
+    impl_t(int const Width, int const Height, size_t const MemoryBudget, std::string SwapFile)
+      : width_         {Width}
+      , height_        {Height}
+      , chunks_w_      {(Width  + chunk_size - 1) >> chunk_bits}
+      , chunks_h_      {(Height + chunk_size - 1) >> chunk_bits}
+      , memory_budget_ {MemoryBudget}
+      , swap_path_     {std::move(SwapFile)}
+      , swap_          {swap_path_, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc}
+      , slots_         (static_cast<size_t>(chunks_w_) * static_cast<size_t>(chunks_h_))
+    {
+        if (!swap_) {
+            swap_file_error(swap_path_, "couldn't open for writing");
+        }
+    }
+
+    ~impl_t() {
+        swap_.close();
+        std::remove(swap_path_.c_str());
+    }
+
+    void clear() {
+        for (auto& s : slots_) {
+            s = slot_t {};
+        }
+
+        lru_first_ = none;
+        lru_last_  = none;
+        resident_  = 0;
+        swap_end_  = 0;
+    }
+
+    template <map_property P>
+    void set(int const x, int const y, mapping_t<P> const value) {
+        BK_ASSERT(is_valid_position(x, y));
+
+        auto& s = slot_of_(x, y);
+        if (!s.data) {
+            if (s.swap_offset < 0) {
+                //writing the default value to an unallocated chunk is a no-op
+                if (value == mapping_t<P> {}) {
+                    return;
+                }
+
+                allocate_(s);
+            } else {
+                page_in_(s);
+            }
+        }
+
+        touch_(s);
+        std::get<static_cast<size_t>(P)>(s.data->columns)(x & chunk_mask, y & chunk_mask) = value;
+    }
+
+    template <map_property P>
+    mapping_t<P> get(int const x, int const y) {
+        BK_ASSERT(is_valid_position(x, y));
+
+        auto& s = slot_of_(x, y);
+        if (!s.data) {
+            if (s.swap_offset < 0) {
+                return mapping_t<P> {};
+            }
+
+            page_in_(s);
+        }
+
+        touch_(s);
+        return std::get<static_cast<size_t>(P)>(s.data->columns)(x & chunk_mask, y & chunk_mask);
+    }
+
+    //! read property P of [x0, x1) of row y into @p out, a chunk at a time.
+    template <map_property P>
+    void read_row(int const x0, int const x1, int const y, mapping_t<P>* out) {
+        BK_ASSERT(is_valid_position(x0, y) && x1 <= width_);
+
+        for (auto x = x0; x < x1;) {
+            auto const n = std::min(chunk_size - (x & chunk_mask), x1 - x);
+
+            auto& s = slot_of_(x, y);
+            if (!s.data && s.swap_offset >= 0) {
+                page_in_(s);
+            }
+
+            if (s.data) {
+                touch_(s);
+                auto const row = std::get<static_cast<size_t>(P)>(s.data->columns).row(y & chunk_mask);
+                std::copy_n(row + (x & chunk_mask), n, out);
+            } else {
+                std::fill_n(out, n, mapping_t<P> {});
+            }
+
+            out += n;
+            x   += n;
+        }
+    }
+
+    bool is_valid_position(int const x, int const y) const {
+        return (x >= 0 && x < width_)
+            && (y >= 0 && y < height_);
+    }
+
+    int width()  const { return width_; }
+    int height() const { return height_; }
+
+    size_t allocated_chunks() const {
+        return static_cast<size_t>(std::count_if(std::begin(slots_), std::end(slots_)
+          , [](slot_t const& s) { return s.data || s.swap_offset >= 0; }));
+    }
+
+    size_t resident_chunks() const {
+        return resident_;
+    }
+
+    static size_t chunk_bytes() {
+        return chunk_bytes_of(std::make_integer_sequence<int, map_property_count> {});
+    }
+private:
+    static int const chunk_mask = chunk_size - 1;
+
+    //! no slot; the end of the lru list.
+    static size_t const none = static_cast<size_t>(-1);
+
+    struct chunk_t {
+        chunk_t() : columns {make_chunk_columns_of(std::make_integer_sequence<int, map_property_count> {})} {}
+        chunk_columns_t columns;
+    };
+
+    //! resident slots are linked in order of use, most recent first.
+    struct slot_t {
+        std::unique_ptr<chunk_t> data;             //!< null unless resident.
+        std::streamoff           swap_offset = -1; //!< -1 until first swapped out.
+        size_t                   prev = none;      //!< the more recently used slot.
+        size_t                   next = none;      //!< the less recently used slot.
+    };
+
+    size_t index_of_(slot_t const& s) const {
+        return static_cast<size_t>(&s - slots_.data());
+    }
+
+    void link_first_(size_t const i) {
+        auto& s = slots_[i];
+        s.prev = none;
+        s.next = lru_first_;
+
+        if (lru_first_ != none) {
+            slots_[lru_first_].prev = i;
+        } else {
+            lru_last_ = i;
+        }
+
+        lru_first_ = i;
+    }
+
+    void unlink_(size_t const i) {
+        auto& s = slots_[i];
+        (s.prev != none ? slots_[s.prev].next : lru_first_) = s.next;
+        (s.next != none ? slots_[s.next].prev : lru_last_)  = s.prev;
+        s.prev = none;
+        s.next = none;
+    }
+
+    //! make the resident slot @p s the most recently used.
+    void touch_(slot_t& s) {
+        auto const i = index_of_(s);
+        if (i != lru_first_) {
+            unlink_(i);
+            link_first_(i);
+        }
+    }
+
+    slot_t& slot_of_(int const x, int const y) {
+        return slots_[static_cast<size_t>(x >> chunk_bits)
+                    + static_cast<size_t>(y >> chunk_bits) * static_cast<size_t>(chunks_w_)];
+    }
+
+    //! evict least recently used chunks until there is room for one more.
+    void make_room_() {
+        while (resident_ > 0 && (resident_ + 1) * chunk_bytes() > memory_budget_) {
+            auto const i = lru_last_;
+
+            page_out_(slots_[i]);
+
+            unlink_(i);
+            --resident_;
+        }
+    }
+
+    void allocate_(slot_t& s) {
+        allocate_(s, std::make_unique<chunk_t>());
+    }
+
+    void allocate_(slot_t& s, std::unique_ptr<chunk_t> data) {
+        make_room_();
+        s.data = std::move(data);
+        link_first_(index_of_(s));
+        ++resident_;
+    }
+
+    //! on failure the chunk stays swapped out.
+    void page_in_(slot_t& s) {
+        BK_ASSERT(s.swap_offset >= 0);
+
+        auto data = std::make_unique<chunk_t>();
+
+        swap_.seekg(s.swap_offset);
+        for_each_column_(*data, [&](char* const bytes, size_t const size) {
+            swap_.read(bytes, static_cast<std::streamsize>(size));
+        });
+
+        if (!swap_) {
+            swap_.clear();
+            swap_file_error(swap_path_, "couldn't read a chunk");
+        }
+
+        allocate_(s, std::move(data));
+    }
+
+    void page_out_(slot_t& s) {
+        BK_ASSERT(s.data);
+
+        //each chunk keeps the same place in the swap file once given one
+        if (s.swap_offset < 0) {
+            s.swap_offset = swap_end_;
+            swap_end_ += static_cast<std::streamoff>(chunk_bytes());
+        }
+
+        swap_.seekp(s.swap_offset);
+        for_each_column_(*s.data, [&](char* const data, size_t const size) {
+            swap_.write(data, static_cast<std::streamsize>(size));
+        });
+
+        //on failure the chunk stays resident
+        if (!swap_) {
+            swap_.clear();
+            swap_file_error(swap_path_, "couldn't write a chunk");
+        }
+
+        s.data.reset();
+    }
+
+    template <typename F>
+    static void for_each_column_(chunk_t& c, F&& function) {
+        for_each_column_(c, function, std::make_integer_sequence<int, map_property_count> {});
+    }
+
+    template <typename F, int... Is>
+    static void for_each_column_(chunk_t& c, F& function, std::integer_sequence<int, Is...>) {
+        auto const expand = {(function(column_bytes(std::get<Is>(c.columns))
+                                     , column_size(std::get<Is>(c.columns))), 0)...};
+        (void)expand;
+    }
+
+    int width_;
+    int height_;
+    int chunks_w_;
+    int chunks_h_;
+
+    size_t       memory_budget_;
+    std::string  swap_path_;
+    std::fstream swap_;
+
+    std::streamoff swap_end_ = 0;
+
+    std::vector<slot_t> slots_;
+
+    size_t lru_first_ = none; //!< the most recently used resident slot.
+    size_t lru_last_  = none; //!< the least recently used resident slot.
+    size_t resident_  = 0;    //!< the number of resident slots.
+};
+
+/////////////////////
+
+paged_map::paged_map(
+    yama::map_size const Width
+  , yama::map_size const Height
+  , size_t       const MemoryBudget
+  , std::string        SwapFile
+)
+  : impl_ {std::make_unique<impl_t>(Width, Height, MemoryBudget, std::move(SwapFile))}
+{
+}
+
+paged_map::~paged_map() {
+}
+
+paged_map::paged_map(paged_map&& other)
+  : impl_ {std::move(other.impl_)}
+{
+}
+
+paged_map& paged_map::operator=(paged_map&& rhs) {
+    std::swap(impl_, rhs.impl_);
+    return *this;
+}
+
+void paged_map::clear() {
+    impl_->clear();
+}
+
+template <map_property P>
+void paged_map::set(int const x, int const y, mapping_t<P> const value) {
+    impl_->set<P>(x, y, value);
+}
+
+template <map_property P>
+paged_map::mapping_t<P> paged_map::get(int const x, int const y) const {
+    return impl_->get<P>(x, y);
+}
+
+template <map_property P>
+void paged_map::read_row(int const x0, int const x1, int const y, mapping_t<P>* const out) const {
+    impl_->read_row<P>(x0, x1, y, out);
+}
+
+namespace {
+
+template <map_property P>
+void blit_property(paged_map& dst, yama::map const& src, int const x0, int const y0) {
+    std::vector<paged_map::mapping_t<P>> row (static_cast<size_t>(src.width()));
+
+    for (int y = 0; y < src.height(); ++y) {
+        src.read_row<P>(y, row.data());
+        for (int x = 0; x < src.width(); ++x) {
+            dst.set<P>(x0 + x, y0 + y, row[x]);
+        }
+    }
+}
+
+template <int... Is>
+void blit_properties(paged_map& dst, yama::map const& src, int const x0, int const y0, std::integer_sequence<int, Is...>) {
+    auto const expand = {(blit_property<static_cast<map_property>(Is)>(dst, src, x0, y0), 0)...};
+    (void)expand;
+}
+
+} //namespace
+
+void paged_map::blit(map const& source, int const x, int const y) {
+    BK_ASSERT(is_valid_position(x, y));
+    BK_ASSERT(is_valid_position(x + source.width() - 1, y + source.height() - 1));
+
+    blit_properties(*this, source, x, y, std::make_integer_sequence<int, map_property_count> {});
+}
+
+namespace {
+
+template <map_property P>
+void extract_property(paged_map const& src, yama::map& dst, yama::rect_t const r) {
+    std::vector<paged_map::mapping_t<P>> row (static_cast<size_t>(r.width()));
+
+    for (int y = r.top; y < r.bottom; ++y) {
+        src.read_row<P>(r.left, r.right, y, row.data());
+        dst.write_rect<P>(yama::rect_t {0, y - r.top, r.width(), y - r.top + 1}, row.data());
+    }
+}
+
+template <int... Is>
+void extract_properties(paged_map const& src, yama::map& dst, yama::rect_t const r, std::integer_sequence<int, Is...>) {
+    auto const expand = {(extract_property<static_cast<map_property>(Is)>(src, dst, r), 0)...};
+    (void)expand;
+}
+
+} //namespace
+
+yama::map paged_map::extract(rect_t const r) const {
+    BK_ASSERT(r.width() > 0 && r.height() > 0);
+    BK_ASSERT(is_valid_position(r.left, r.top));
+    BK_ASSERT(is_valid_position(r.right - 1, r.bottom - 1));
+
+    map result {r.width(), r.height()};
+
+    extract_properties(*this, result, r, std::make_integer_sequence<int, map_property_count> {});
+
+    return result;
+}
+
+bool paged_map::is_valid_position(int const x, int const y) const {
+    return impl_->is_valid_position(x, y);
+}
+
+int paged_map::width() const {
+    return impl_->width();
+}
+
+int paged_map::height() const {
+    return impl_->height();
+}
+
+size_t paged_map::allocated_chunks() const {
+    return impl_->allocated_chunks();
+}
+
+size_t paged_map::resident_chunks() const {
+    return impl_->resident_chunks();
+}
+
+size_t paged_map::chunk_bytes() {
+    return impl_t::chunk_bytes();
+}
+
+//==============================================================================
+//! Explicit instantiations; one line per property.
+//==============================================================================
+#define YAMA_PAGED_MAP_INSTANTIATE(P) \
+template void paged_map::set<P>(int, int, paged_map::mapping_t<P>); \
+template paged_map::mapping_t<P> paged_map::get<P>(int, int) const; \
+template void paged_map::read_row<P>(int, int, int, paged_map::mapping_t<P>*) const
+
+YAMA_PAGED_MAP_INSTANTIATE(map_property::category);
+YAMA_PAGED_MAP_INSTANTIATE(map_property::room_id);
+YAMA_PAGED_MAP_INSTANTIATE(map_property::texture_id);
+
+#undef YAMA_PAGED_MAP_INSTANTIATE
@@ -60,6 +60,13 @@ public:
         SDL_RenderDrawRect(renderer_.get(), &rect);
     }
 
+    void fill_rects(int_rect const* const rects, size_t const n) {
+        SDL_RenderFillRects(renderer_.get(), to_sdl_(rects, n), static_cast<int>(n));
+    }
+
+    void draw_rects(int_rect const* const rects, size_t const n) {
+        SDL_RenderDrawRects(renderer_.get(), to_sdl_(rects, n), static_cast<int>(n));
+    }
 
     void clear() {
         SDL_RenderClear(renderer_.get());
@@ -70,7 +77,18 @@ public:
     }
 
 private:
-    renderer_ptr renderer_;
+    //! @p rects as SDL_Rects; valid until the next call.
+    SDL_Rect const* to_sdl_(int_rect const* const rects, size_t const n) {
+        rects_.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            rects_[i] = SDL_Rect {rects[i].x, rects[i].y, rects[i].w, rects[i].h};
+        }
+
+        return rects_.data();
+    }
+
+    renderer_ptr          renderer_;
+    std::vector<SDL_Rect> rects_; //!< reused by to_sdl_.
 };
 
 
@@ -99,6 +117,14 @@ void renderer::draw_rect(int x, int y, int w, int h) {
     impl_->draw_rect(x, y, w, h);
 }
 
+void renderer::fill_rects(int_rect const* const rects, size_t const n) {
+    impl_->fill_rects(rects, n);
+}
+
+void renderer::draw_rects(int_rect const* const rects, size_t const n) {
+    impl_->draw_rects(rects, n);
+}
+
 void renderer::clear() {
     impl_->clear();
 }
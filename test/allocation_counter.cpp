@@ -0,0 +1,49 @@
+#include "pch.hpp"
+#include "allocation_counter.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+using yama::test::allocation_counter;
+
+namespace {
+
+std::atomic<size_t> allocation_count  {0}; //!< while any counter exists.
+std::atomic<int>    counters_in_scope {0};
+
+} //namespace
+
+void* operator new(std::size_t const size) {
+    if (counters_in_scope.load(std::memory_order_relaxed) > 0) {
+        ++allocation_count;
+    }
+
+    if (auto const p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+
+    throw std::bad_alloc {};
+}
+
+void operator delete(void* const p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* const p, std::size_t) noexcept {
+    std::free(p);
+}
+
+allocation_counter::allocation_counter()
+  : start_ {allocation_count.load()}
+{
+    ++counters_in_scope;
+}
+
+allocation_counter::~allocation_counter() {
+    --counters_in_scope;
+}
+
+size_t allocation_counter::count() const {
+    return allocation_count.load() - start_;
+}
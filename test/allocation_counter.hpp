@@ -0,0 +1,34 @@
+////////////////////////////////////////////////////////////////////////////////
+//! @file
+//! Counting of heap allocations, for tests; test program only.
+////////////////////////////////////////////////////////////////////////////////
+#pragma once
+
+#include <cstddef>
+
+namespace yama {
+namespace test {
+
+////////////////////////////////////////////////////////////////////////////////
+//! Counts the calls to operator new made, by any thread, while it exists.
+//!
+//! The counting operator new is defined in allocation_counter.cpp, which is
+//! built into the test program only; outside the scope of a counter it only
+//! checks a flag.
+////////////////////////////////////////////////////////////////////////////////
+class allocation_counter {
+public:
+    allocation_counter();
+    ~allocation_counter();
+
+    //! the allocations made since construction.
+    size_t count() const;
+private:
+    allocation_counter(allocation_counter const&) = delete;
+    allocation_counter& operator=(allocation_counter const&) = delete;
+
+    size_t start_;
+};
+
+} //namespace test
+} //namespace yama
@@ -3,9 +3,136 @@
 #include <catch/catch.hpp>
 
 #include "detail/bsp_layout_impl.hpp"
+#include "connectivity.hpp"
+#include "allocation_counter.hpp"
 
 using bsp_layout_impl = yama::detail::bsp_layout_impl;
 using yama::rect_t;
+using yama::map_property;
+using yama::grid;
+
+namespace {
+
+bool same_tiles(yama::map const& a, yama::map const& b) {
+    if (a.width() != b.width() || a.height() != b.height()) {
+        return false;
+    }
+
+    for (int y = 0; y < a.height(); ++y) {
+        for (int x = 0; x < a.width(); ++x) {
+            if (a.get<map_property::category>(x, y) != b.get<map_property::category>(x, y)
+             || a.get<map_property::room_id>(x, y)  != b.get<map_property::room_id>(x, y)
+            ) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool is_connected_tile(yama::tile_category const c) {
+    return c == yama::tile_category::floor
+        || c == yama::tile_category::corridor
+        || c == yama::tile_category::door
+        || c == yama::tile_category::stair;
+}
+
+} //namespace
+
+TEST_CASE("generate_batch", "[bsp_layout]") {
+    yama::bsp_layout::params_t params;
+    params.map_w = 80;
+    params.map_h = 60;
+
+    std::vector<uint32_t> const seeds {1002, 7, 7, 123456, 42};
+
+    auto const serial = yama::generate_batch(seeds, params, 1);
+    REQUIRE(serial.size() == seeds.size());
+
+    //same as generating each level on its own
+    for (size_t i = 0; i < seeds.size(); ++i) {
+        yama::random_t random {seeds[i]};
+        REQUIRE(same_tiles(serial[i], yama::bsp_layout {params}.generate(random)));
+    }
+
+    REQUIRE(same_tiles(serial[1], serial[2]));
+    REQUIRE(!same_tiles(serial[0], serial[1]));
+
+    //and independent of the thread count
+    for (int threads : {2, 3, 8}) {
+        auto const batch = yama::generate_batch(seeds, params, threads);
+        REQUIRE(batch.size() == seeds.size());
+
+        for (size_t i = 0; i < seeds.size(); ++i) {
+            REQUIRE(same_tiles(batch[i], serial[i]));
+        }
+    }
+
+    REQUIRE(yama::generate_batch({}, params).empty());
+}
+
+TEST_CASE("generate_into", "[bsp_layout]") {
+    yama::bsp_layout::params_t params;
+    params.map_w = 80;
+    params.map_h = 60;
+
+    yama::bsp_layout layout {params};
+
+    //wrong size; replaced
+    yama::map m {10, 10};
+
+    for (uint32_t const seed : {1002u, 7u, 123456u}) {
+        yama::random_t r0 {seed};
+        yama::random_t r1 {seed};
+
+        layout.generate_into(m, r0);
+        REQUIRE(same_tiles(m, layout.generate(r1)));
+    }
+
+    REQUIRE(m.width()  == 80);
+    REQUIRE(m.height() == 60);
+}
+
+TEST_CASE("generate_into a map of the same size doesn't allocate", "[bsp_layout]") {
+    yama::bsp_layout::params_t params;
+    params.map_w = 80;
+    params.map_h = 60;
+
+    yama::bsp_layout layout {params};
+    yama::map m {80, 60};
+
+    //the first call sizes the scratch space
+    yama::random_t r0 {1002};
+    layout.generate_into(m, r0);
+
+    //including for seeds it hasn't seen
+    for (uint32_t const seed : {7u, 123456u, 1002u, 0u, 1u, 2u, 3u, 4u, 5u, 6u, 8u}) {
+        yama::random_t r1 {seed};
+
+        size_t allocations = 0;
+        {
+            yama::test::allocation_counter const counter;
+            layout.generate_into(m, r1);
+            allocations = counter.count();
+        }
+
+        REQUIRE(allocations == 0);
+    }
+
+    //while a map of another size is replaced
+    yama::map small {10, 10};
+    yama::random_t r2 {1002};
+
+    size_t allocations = 0;
+    {
+        yama::test::allocation_counter const counter;
+        layout.generate_into(small, r2);
+        allocations = counter.count();
+    }
+
+    REQUIRE(allocations > 0);
+}
 
 //TEST_CASE("bsp_layout_regions", "[bsp_layout]") {
 //    yama::random_t random {1002};
@@ -44,3 +171,79 @@ using yama::rect_t;
 //    bsp.clear();
 ////}
 //}
+
+TEST_CASE("routed corridors connect every room", "[bsp_layout]") {
+    yama::bsp_layout::params_t params;
+    params.route_corridors = true;
+
+    for (int const size : {64, 128}) {
+        params.map_w = size;
+        params.map_h = size;
+
+        yama::bsp_layout layout {params};
+
+        for (uint32_t seed = 0; seed < 50; ++seed) {
+            yama::random_t random {seed};
+            auto const m = layout.generate(random);
+
+            grid<yama::component_label_t> labels {m.width(), m.height()};
+
+            INFO("size " << size << " seed " << seed);
+            REQUIRE(yama::label_components(m, is_connected_tile, labels, 1) <= 1);
+        }
+    }
+}
+
+TEST_CASE("subtree generation is independent of the thread count", "[bsp_layout]") {
+    yama::bsp_layout::params_t params;
+    params.map_w = 300;
+    params.map_h = 200;
+    params.subtree_area = 64 * 64;
+
+    yama::bsp_layout layout {params};
+
+    for (uint32_t const seed : {1u, 1002u}) {
+        layout.set_thread_count(1);
+
+        yama::random_t r0 {seed};
+        auto const expected = layout.generate(r0);
+        auto const expected_regions = layout.get_regions();
+
+        //the leaves of the spliced tree still partition the map
+        int area = 0;
+        for (auto const& r : expected_regions) {
+            REQUIRE(r.width()  <= params.region_w_range.upper);
+            REQUIRE(r.height() <= params.region_h_range.upper);
+            area += r.area();
+        }
+        REQUIRE(area == params.map_w * params.map_h);
+
+        for (int const threads : {2, 3, 8}) {
+            layout.set_thread_count(threads);
+
+            yama::random_t r1 {seed};
+            REQUIRE(same_tiles(layout.generate(r1), expected));
+            REQUIRE(layout.get_regions() == expected_regions);
+        }
+    }
+}
+
+TEST_CASE("routed subtrees connect every room", "[bsp_layout]") {
+    yama::bsp_layout::params_t params;
+    params.map_w = 256;
+    params.map_h = 256;
+    params.subtree_area = 64 * 64;
+    params.route_corridors = true;
+
+    yama::bsp_layout layout {params};
+
+    for (uint32_t seed = 0; seed < 10; ++seed) {
+        yama::random_t random {seed};
+        auto const m = layout.generate(random);
+
+        grid<yama::component_label_t> labels {m.width(), m.height()};
+
+        INFO("seed " << seed);
+        REQUIRE(yama::label_components(m, is_connected_tile, labels, 1) == 1);
+    }
+}
@@ -0,0 +1,166 @@
+#include "pch.hpp"
+#include "cave_layout.hpp"
+
+#include <catch/catch.hpp>
+
+#include <algorithm>
+#include <vector>
+
+using yama::map;
+using yama::map_property;
+using yama::tile_category;
+
+namespace {
+
+std::vector<bool> walls_of(map const& m) {
+    std::vector<bool> result;
+    for (int y = 0; y < m.height(); ++y) {
+        for (int x = 0; x < m.width(); ++x) {
+            result.push_back(m.get<map_property::category>(x, y) == tile_category::wall);
+        }
+    }
+    return result;
+}
+
+//! one step of the 4-5 rule, a tile at a time.
+std::vector<bool> smooth(std::vector<bool> const& walls, int const w, int const h) {
+    auto const is_wall = [&](int const x, int const y) {
+        return x < 0 || y < 0 || x >= w || y >= h || walls[static_cast<size_t>(x + y * w)];
+    };
+
+    std::vector<bool> result(walls.size());
+
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            int n = 0;
+            for (int yi = y - 1; yi <= y + 1; ++yi) {
+                for (int xi = x - 1; xi <= x + 1; ++xi) {
+                    n += is_wall(xi, yi) ? 1 : 0;
+                }
+            }
+
+            auto const edge = x == 0 || y == 0 || x == w - 1 || y == h - 1;
+            result[static_cast<size_t>(x + y * w)] = edge || n >= 5;
+        }
+    }
+
+    return result;
+}
+
+} //namespace
+
+TEST_CASE("cave layout matches the tile at a time rule", "[cave_layout]") {
+    for (auto const size : {yama::grid_position_t {100, 70}, yama::grid_position_t {128, 64}, yama::grid_position_t {10, 10}}) {
+        yama::cave_layout::params_t params;
+        params.map_w      = size.x;
+        params.map_h      = size.y;
+        params.iterations = 0;
+
+        yama::random_t random0 {7};
+        auto walls = walls_of(yama::cave_layout {params}.generate(random0));
+
+        for (int i = 1; i <= 5; ++i) {
+            walls = smooth(walls, size.x, size.y);
+
+            params.iterations = i;
+            yama::random_t random {7};
+            REQUIRE(walls_of(yama::cave_layout {params}.generate(random)) == walls);
+        }
+    }
+}
+
+TEST_CASE("cave layout wall chance", "[cave_layout]") {
+    yama::cave_layout::params_t params;
+    params.map_w      = 70;
+    params.map_h      = 30;
+    params.iterations = 0;
+
+    yama::random_t random {1};
+
+    auto const count_walls = [&] {
+        auto const walls = walls_of(yama::cave_layout {params}.generate(random));
+        return std::count(walls.begin(), walls.end(), true);
+    };
+
+    auto const edge = 2 * 70 + 2 * 28;
+
+    params.wall_chance = 0;
+    REQUIRE(count_walls() == edge);
+
+    params.wall_chance = 100;
+    REQUIRE(count_walls() == 70 * 30);
+
+    params.wall_chance = 45;
+    auto const interior = count_walls() - edge;
+    REQUIRE(interior > 68 * 28 * 35 / 100);
+    REQUIRE(interior < 68 * 28 * 55 / 100);
+}
+
+TEST_CASE("cave layout generate_into reuses the map", "[cave_layout]") {
+    yama::cave_layout layout;
+
+    yama::random_t random0 {3};
+    auto const expected = walls_of(layout.generate(random0));
+
+    map m {64, 64};
+    m.fill_rect<map_property::category>(yama::rect_t {0, 0, 64, 64}, tile_category::door);
+
+    yama::random_t random {3};
+    layout.generate_into(m, random);
+    REQUIRE(walls_of(m) == expected);
+    REQUIRE(m.get<map_property::category>(5, 0) == tile_category::wall);
+}
+
+TEST_CASE("cave layout start depends only on position", "[cave_layout]") {
+    yama::cave_layout::params_t params;
+    params.iterations = 0;
+
+    auto const start_of = [&](int const w, int const h) {
+        params.map_w = w;
+        params.map_h = h;
+
+        yama::random_t random {11};
+        return yama::cave_layout {params}.generate(random);
+    };
+
+    auto const small = start_of(40, 30);
+    auto const large = start_of(90, 70);
+
+    //all but the edge of the smaller map, which is forced to wall
+    for (int y = 1; y < 29; ++y) {
+        for (int x = 1; x < 39; ++x) {
+            REQUIRE(small.get<map_property::category>(x, y) == large.get<map_property::category>(x, y));
+        }
+    }
+}
+
+TEST_CASE("cave layout region matches the larger map", "[cave_layout]") {
+    yama::cave_layout::params_t params;
+    params.iterations = 4;
+
+    params.map_w = 200;
+    params.map_h = 150;
+
+    yama::random_t random0 {5};
+    auto const large = yama::cave_layout {params}.generate(random0);
+
+    //a chunk away from the edges of the larger map
+    yama::rect_t const r {70, 45, 140, 100};
+    params.map_w = r.width();
+    params.map_h = r.height();
+    params.x0    = r.left;
+    params.y0    = r.top;
+
+    yama::random_t random {5};
+    auto const chunk = yama::cave_layout {params}.generate(random);
+
+    //all but where the forced edge of the chunk reaches
+    auto const margin = params.iterations + 1;
+
+    for (int y = margin; y < r.height() - margin; ++y) {
+        for (int x = margin; x < r.width() - margin; ++x) {
+            REQUIRE(chunk.get<map_property::category>(x, y)
+                 == large.get<map_property::category>(r.left + x, r.top + y));
+        }
+    }
+}
@@ -0,0 +1,155 @@
+#include "pch.hpp"
+#include "connectivity.hpp"
+#include "bsp_layout.hpp"
+#include "grid_kernels.hpp"
+
+#include <catch/catch.hpp>
+
+#include <set>
+
+using yama::grid;
+using yama::map;
+using yama::map_property;
+using yama::tile_category;
+using yama::component_label_t;
+
+namespace {
+
+bool is_passable(tile_category const c) {
+    return c == tile_category::floor
+        || c == tile_category::corridor
+        || c == tile_category::door;
+}
+
+//! reference labeling: one flood fill per unlabeled passable tile.
+int reference_labels(grid<uint8_t> const& mask, grid<component_label_t>& labels) {
+    labels.clear();
+
+    int count = 0;
+    for (int y = 0; y < mask.height(); ++y) {
+        for (int x = 0; x < mask.width(); ++x) {
+            if (!mask(x, y) || labels(x, y)) {
+                continue;
+            }
+
+            ++count;
+            yama::scanline_fill(mask.width(), mask.height(), x, y
+              , [&](int const xi, int const yi) { return mask(xi, yi) != 0; }
+              , [&](int const yi, int const x0, int const x1) {
+                    std::fill(labels.row(yi) + x0, labels.row(yi) + x1, static_cast<component_label_t>(count));
+                });
+        }
+    }
+
+    return count;
+}
+
+} //namespace
+
+TEST_CASE("label_components", "[connectivity]") {
+    // #  = wall; components are labeled in raster order of their first tile
+    char const* const rows[] = {
+        "..#...."
+      , "..#.##."
+      , "###.##."
+      , "....#.#"
+    };
+
+    grid<char> g {7, 4};
+    for (int y = 0; y < 4; ++y) {
+        for (int x = 0; x < 7; ++x) {
+            g(x, y) = rows[y][x];
+        }
+    }
+
+    grid<component_label_t> labels {7, 4};
+    auto const count = yama::label_components(g, [](char const c) { return c == '.'; }, labels);
+
+    REQUIRE(count == 3);
+    REQUIRE(labels(0, 0) == 1);
+    REQUIRE(labels(1, 1) == 1);
+    REQUIRE(labels(3, 0) == 2);
+    REQUIRE(labels(0, 3) == 2);
+    REQUIRE(labels(6, 2) == 2);
+    REQUIRE(labels(2, 0) == 0);
+    REQUIRE(labels(4, 3) == 0);
+
+    //walled in on three sides and the edge
+    REQUIRE(labels(5, 3) == 3);
+}
+
+TEST_CASE("label_components matches flood fill with any thread count", "[connectivity]") {
+    int const w = 300;
+    int const h = 257;
+
+    yama::random_t random {7};
+
+    grid<uint8_t> mask {w, h};
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            mask(x, y) = (random() % 100 < 55) ? 1 : 0;
+        }
+    }
+
+    grid<component_label_t> expected {w, h};
+    auto const expected_count = reference_labels(mask, expected);
+
+    for (int threads : {1, 2, 3, 4}) {
+        grid<component_label_t> labels {w, h};
+        auto const count = yama::label_components(mask, [](uint8_t const v) { return v != 0; }, labels, threads);
+
+        REQUIRE(count == expected_count);
+        REQUIRE(yama::equal(labels, expected));
+    }
+}
+
+TEST_CASE("connectivity on maps", "[connectivity]") {
+    yama::bsp_layout::params_t params;
+    params.map_w = 100;
+    params.map_h = 80;
+
+    yama::random_t random {1002};
+    auto m = yama::bsp_layout {params}.generate(random);
+
+    auto const count = yama::label_rooms(m, is_passable);
+    REQUIRE(count >= 1);
+
+    std::set<int> seen;
+    for (int y = 0; y < m.height(); ++y) {
+        for (int x = 0; x < m.width(); ++x) {
+            auto const id = m.get<map_property::room_id>(x, y);
+            if (is_passable(m.get<map_property::category>(x, y))) {
+                REQUIRE(id >= 1);
+                REQUIRE(id <= count);
+                seen.insert(id);
+            } else {
+                REQUIRE(id == 0);
+            }
+        }
+    }
+    REQUIRE(static_cast<int>(seen.size()) == count);
+
+    SECTION("flood fill") {
+        //find a passable tile and refill its component
+        for (int y = 0; y < m.height(); ++y) {
+            for (int x = 0; x < m.width(); ++x) {
+                if (!is_passable(m.get<map_property::category>(x, y))) {
+                    continue;
+                }
+
+                auto const id = m.get<map_property::room_id>(x, y);
+
+                size_t size = 0;
+                for (int yi = 0; yi < m.height(); ++yi) {
+                    for (int xi = 0; xi < m.width(); ++xi) {
+                        size += (m.get<map_property::room_id>(xi, yi) == id) ? 1 : 0;
+                    }
+                }
+
+                REQUIRE(yama::flood_fill(m, x, y, is_passable, 999) == size);
+                REQUIRE(m.get<map_property::room_id>(x, y) == 999);
+                return;
+            }
+        }
+    }
+}
@@ -0,0 +1,69 @@
+#include "pch.hpp"
+#include "dirty_tracker.hpp"
+#include "map.hpp"
+
+#include <catch/catch.hpp>
+
+using yama::dirty_tracker;
+using yama::rect_t;
+
+TEST_CASE("dirty_tracker", "[dirty_tracker]") {
+    dirty_tracker d {100, 70};
+
+    //everything starts dirty
+    REQUIRE(d.epoch() == 0);
+    REQUIRE(d.changed_since(0) == (std::vector<rect_t> {{0, 0, 100, 70}}));
+
+    auto const e1 = d.next_epoch();
+    REQUIRE(e1 == 1);
+    REQUIRE(d.changed_since(e1).empty());
+    REQUIRE(!d.is_changed_since(e1));
+
+    SECTION("single tile") {
+        d.mark(17, 40);
+        REQUIRE(d.changed_since(e1) == (std::vector<rect_t> {{16, 32, 32, 48}}));
+    }
+
+    SECTION("clipped to the area") {
+        d.mark(99, 69);
+        REQUIRE(d.changed_since(e1) == (std::vector<rect_t> {{96, 64, 100, 70}}));
+    }
+
+    SECTION("rects are merged") {
+        d.mark(rect_t {0, 0, 40, 40});
+        d.mark(rect_t {70, 0, 80, 10});
+
+        REQUIRE(d.changed_since(e1) == (std::vector<rect_t> {{0, 0, 48, 48}, {64, 0, 80, 16}}));
+    }
+
+    SECTION("epochs") {
+        d.mark(0, 0);
+        auto const e2 = d.next_epoch();
+        d.mark(50, 50);
+
+        REQUIRE(d.changed_since(e2) == (std::vector<rect_t> {{48, 48, 64, 64}}));
+        REQUIRE(d.changed_since(e1).size() == 2);
+
+        //older than the history; everything
+        for (int i = 0; i < dirty_tracker::history; ++i) {
+            d.next_epoch();
+        }
+
+        REQUIRE(d.changed_since(e2) == (std::vector<rect_t> {{0, 0, 100, 70}}));
+        REQUIRE(!d.is_changed_since(d.epoch()));
+    }
+}
+
+TEST_CASE("map tracks changes", "[dirty_tracker]") {
+    using yama::map_property;
+
+    yama::map m {64, 64};
+
+    auto const seen = m.next_epoch();
+    REQUIRE(m.changed_since(seen).empty());
+
+    m.set<map_property::category>(3, 3, yama::tile_category::floor);
+    m.fill_rect<map_property::room_id>(rect_t {40, 40, 50, 50}, 3);
+
+    REQUIRE(m.changed_since(seen) == (std::vector<rect_t> {{0, 0, 16, 16}, {32, 32, 64, 64}}));
+}
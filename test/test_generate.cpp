@@ -38,6 +38,75 @@ TEST_CASE("test distribution", "[generate]") {
 }
 
 
+namespace {
+
+//! weighted_range as it was: rejection sampling of a normal distribution.
+int reference_weighted_range(
+    random_t& random, closed_integral_interval<int> const range, int const weight, int const variance
+) {
+    auto const mean   = ((weight   / 100.0) + 1.0) / 2.0;
+    auto const stddev = ((variance / 100.0) + 1.0) / 2.0;
+    auto       dist   = std::normal_distribution<double> {mean, stddev};
+
+    auto const a     = static_cast<double>(range.lower);
+    auto const delta = static_cast<double>(range.upper) - a;
+
+    auto const lower_limit = -0.5 / delta;
+    auto const upper_limit = (delta + 0.5) / delta;
+
+    auto n = dist(random);
+    while (!(n > lower_limit && n < upper_limit)) {
+        n = dist(random);
+    }
+
+    return static_cast<int>(std::round(a + delta * n));
+}
+
+} //namespace
+
+TEST_CASE("weighted range matches the normal distribution", "[generate]") {
+    yama::random_t random {1011};
+
+    constexpr int n = 200000;
+
+    struct param_set { int lower, upper, weight, variance; };
+
+    for (auto const p : {
+        param_set {0, 99, -100, -75}
+      , param_set {0, 99, 0, 0}
+      , param_set {4, 25, 50, -50}
+      , param_set {4, 25, 100, 100}
+      , param_set {1, 3, -20, 10}
+    }) {
+        auto const range = closed_integral_interval<> {p.lower, p.upper};
+        auto const count = static_cast<size_t>(p.upper - p.lower + 1);
+
+        std::vector<double> expected (count, 0.0);
+        std::vector<double> actual   (count, 0.0);
+
+        for (int i = 0; i < n; ++i) {
+            expected[static_cast<size_t>(reference_weighted_range(random, range, p.weight, p.variance) - p.lower)] += 1;
+            actual[static_cast<size_t>(generate::weighted_range(random, range, p.weight, p.variance) - p.lower)] += 1;
+        }
+
+        //two sample chi-squared over the bins either sample reached
+        double chi2 = 0.0;
+        int    bins = 0;
+        for (size_t i = 0; i < count; ++i) {
+            auto const sum = expected[i] + actual[i];
+            if (sum > 0) {
+                auto const d = expected[i] - actual[i];
+                chi2 += d * d / sum;
+                ++bins;
+            }
+        }
+
+        //the 99.9th percentile is below 2 * df + 20 for these bin counts
+        INFO(p.lower << " " << p.upper << " " << p.weight << " " << p.variance << " chi2=" << chi2);
+        REQUIRE(chi2 < 2.0 * (bins - 1) + 20.0);
+    }
+}
+
 TEST_CASE("generate range value", "[generate]") {
     yama::random_t random {1011};
 
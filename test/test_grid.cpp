@@ -45,3 +45,55 @@ TEST_CASE("grid can be initialized and cleared", "[grid]") {
         check_values(grid, int {});
     }
 }
+
+TEST_CASE("chunked grid matches flat grid", "[grid]") {
+    auto const check = [](int const w, int const h) {
+        yama::grid<int>             flat    {w, h};
+        yama::chunked_grid<int, 2>  chunked {w, h};
+
+        for (int y = 0; y < h; ++y) {
+            for (int x = 0; x < w; ++x) {
+                flat(x, y)    = x + y*w;
+                chunked(x, y) = x + y*w;
+            }
+        }
+
+        std::vector<int> visited (w*h, 0);
+
+        yama::for_each_xy(chunked, [&](int const x, int const y, int const val) {
+            REQUIRE(val == flat(x, y));
+            visited[x + y*w] += 1;
+        });
+
+        for (auto const& n : visited) {
+            REQUIRE(n == 1);
+        }
+    };
+
+    SECTION("square, chunk aligned") { check(16, 16); }
+    SECTION("square, not aligned")   { check(13, 13); }
+    SECTION("wide")                  { check(70, 9); }
+    SECTION("tall")                  { check(5, 37); }
+}
+
+TEST_CASE("chunked grid walks chunk by chunk", "[grid]") {
+    yama::chunked_grid<int, 2> grid {8, 8};
+
+    std::vector<yama::grid_position_t> order;
+    yama::for_each_xy(grid, [&](int const x, int const y, int) {
+        order.emplace_back(x, y);
+    });
+
+    REQUIRE(order.size() == 64);
+
+    //the first chunk is completed before any other is started
+    for (size_t i = 0; i < 16; ++i) {
+        REQUIRE(order[i].x < 4);
+        REQUIRE(order[i].y < 4);
+    }
+
+    //Z order: (0, 0), (1, 0), (0, 1), (1, 1)
+    REQUIRE(order[16] == (yama::grid_position_t {4, 0}));
+    REQUIRE(order[32] == (yama::grid_position_t {0, 4}));
+    REQUIRE(order[48] == (yama::grid_position_t {4, 4}));
+}
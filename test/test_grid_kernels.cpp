@@ -0,0 +1,146 @@
+#include "pch.hpp"
+#include "grid_kernels.hpp"
+#include "tile.hpp"
+
+#include <catch/catch.hpp>
+
+using yama::grid;
+using yama::rect_t;
+
+namespace {
+
+//! a grid of values in [0, range) with an awkward width so rows have tails.
+template <typename T>
+grid<T> make_random_grid(int const w, int const h, int const range, uint32_t const seed) {
+    yama::random_t random {seed};
+
+    grid<T> result {w, h};
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            result(x, y) = static_cast<T>(random() % static_cast<uint32_t>(range));
+        }
+    }
+
+    return result;
+}
+
+template <typename T>
+void check_kernels() {
+    int const w = 77;
+    int const h = 23;
+
+    auto const a = make_random_grid<T>(w, h, 5, 1);
+    auto       b = make_random_grid<T>(w, h, 5, 2);
+
+    rect_t const r {3, 2, 70, 20};
+
+    size_t expected_count = 0;
+    size_t expected_rect_count = 0;
+    std::vector<size_t> expected_histogram (5);
+    std::vector<size_t> expected_rect_histogram (5);
+
+    yama::for_each_xy(a, [&](int const x, int const y, T const value) {
+        if (value == static_cast<T>(2)) {
+            ++expected_count;
+            expected_rect_count += r.contains(x, y) ? 1 : 0;
+        }
+        ++expected_histogram[static_cast<size_t>(value)];
+        expected_rect_histogram[static_cast<size_t>(value)] += r.contains(x, y) ? 1 : 0;
+    });
+
+    REQUIRE(yama::count_if_equal(a, static_cast<T>(2)) == expected_count);
+    REQUIRE(yama::count_if_equal(a, r, static_cast<T>(2)) == expected_rect_count);
+
+    std::vector<size_t> histogram (5);
+    yama::histogram(a, histogram.data(), 5);
+    REQUIRE(histogram == expected_histogram);
+
+    //values outside of the bins aren't counted
+    std::vector<size_t> partial (2);
+    yama::histogram(a, partial.data(), 2);
+    REQUIRE(partial[0] == expected_histogram[0]);
+    REQUIRE(partial[1] == expected_histogram[1]);
+
+    //many bins take the scalar path
+    std::vector<size_t> wide (300);
+    yama::histogram(a, wide.data(), 300);
+    REQUIRE(std::equal(expected_histogram.begin(), expected_histogram.end(), wide.begin()));
+
+    //within a rect, on both paths
+    for (int const bins : {5, 300}) {
+        std::vector<size_t> rect_histogram (static_cast<size_t>(bins));
+        yama::histogram(a, r, rect_histogram.data(), bins);
+        REQUIRE(std::equal(expected_rect_histogram.begin(), expected_rect_histogram.end(), rect_histogram.begin()));
+    }
+
+    REQUIRE(yama::equal(a, a));
+    REQUIRE(!yama::equal(a, b));
+
+    grid<uint8_t> mask {w, h, 7};
+    auto const diffs = yama::diff_mask(a, b, mask);
+
+    size_t expected_diffs = 0;
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            auto const d = a(x, y) != b(x, y);
+            REQUIRE(mask(x, y) == (d ? 1 : 0));
+            expected_diffs += d ? 1 : 0;
+        }
+    }
+    REQUIRE(diffs == expected_diffs);
+
+    //replace within a rect, then the whole grid
+    auto c = a;
+    yama::replace(c, r, static_cast<T>(2), static_cast<T>(4));
+    REQUIRE(yama::count_if_equal(c, static_cast<T>(2)) == expected_count - expected_rect_count);
+    REQUIRE(yama::count_if_equal(c, r, static_cast<T>(2)) == 0);
+
+    yama::replace(c, static_cast<T>(2), static_cast<T>(4));
+    REQUIRE(yama::count_if_equal(c, static_cast<T>(2)) == 0);
+    REQUIRE(yama::count_if_equal(c, static_cast<T>(4)) == expected_count + expected_histogram[4]);
+
+    //fill the rect of b from a; only the rect then compares equal
+    for (int y = r.top; y < r.bottom; ++y) {
+        for (int x = r.left; x < r.right; ++x) {
+            b(x, y) = a(x, y);
+        }
+    }
+    REQUIRE(yama::equal(a, b, r));
+    REQUIRE(!yama::equal(a, b));
+
+    grid<uint8_t> rect_mask {w, h, 7};
+    REQUIRE(yama::diff_mask(a, b, r, rect_mask) == 0);
+    REQUIRE(rect_mask(r.left, r.top) == 0);
+    REQUIRE(rect_mask(0, 0) == 7);
+
+    yama::fill_rect(b, r, static_cast<T>(3));
+    REQUIRE(yama::count_if_equal(b, r, static_cast<T>(3)) == static_cast<size_t>(r.area()));
+}
+
+} //namespace
+
+TEST_CASE("grid kernels", "[grid_kernels]") {
+    INFO(yama::grid_kernels_isa());
+
+    check_kernels<uint8_t>();
+    check_kernels<uint16_t>();
+    check_kernels<uint32_t>();
+    check_kernels<yama::tile_category>();
+}
+
+TEST_CASE("grid kernels histogram spills lane counters", "[grid_kernels]") {
+    //enough values that 8 bit lanes would overflow without spilling
+    auto const g = make_random_grid<uint8_t>(1000, 100, 3, 3);
+
+    size_t expected[3] = {};
+    yama::for_each_xy(g, [&](int, int, uint8_t const value) {
+        ++expected[value];
+    });
+
+    size_t counts[3] = {};
+    yama::histogram(g, counts, 3);
+
+    REQUIRE(counts[0] == expected[0]);
+    REQUIRE(counts[1] == expected[1]);
+    REQUIRE(counts[2] == expected[2]);
+}
@@ -0,0 +1,121 @@
+#include "pch.hpp"
+#include "layout_pipeline.hpp"
+
+#include <catch/catch.hpp>
+
+using yama::map;
+using yama::map_property;
+using yama::layout_pipeline;
+
+namespace {
+
+bool same_categories(map const& a, map const& b) {
+    if (a.width() != b.width() || a.height() != b.height()) {
+        return false;
+    }
+
+    for (int y = 0; y < a.height(); ++y) {
+        for (int x = 0; x < a.width(); ++x) {
+            if (a.get<map_property::category>(x, y) != b.get<map_property::category>(x, y)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+} //namespace
+
+TEST_CASE("layout pipeline defaults match bsp_layout", "[layout_pipeline]") {
+    yama::bsp_layout::params_t params;
+    params.map_w = 96;
+    params.map_h = 80;
+
+    layout_pipeline pipeline {params};
+    yama::bsp_layout layout {params};
+
+    for (uint32_t seed = 1; seed <= 20; ++seed) {
+        yama::random_t random {seed};
+        auto const expected = layout.generate(random);
+
+        REQUIRE(same_categories(pipeline.generate(seed), expected));
+        REQUIRE(pipeline.rooms().rooms == layout.get_rooms());
+        REQUIRE(pipeline.features().stairs.size() == (layout.get_rooms().empty() ? 0u : 2u));
+    }
+}
+
+TEST_CASE("layout pipeline memoizes stages", "[layout_pipeline]") {
+    yama::bsp_layout::params_t params;
+    params.map_w = 96;
+    params.map_h = 80;
+
+    layout_pipeline pipeline {params};
+
+    int corridor_runs = 0;
+    pipeline.set_corridors_stage([&](layout_pipeline::layout_t& layout, yama::random_t& random
+                                   , layout_pipeline::rooms_t const& in, map& out) {
+        ++corridor_runs;
+        layout_pipeline::default_corridors()(layout, random, in, out);
+    });
+
+    auto const first = pipeline.generate(5);
+    REQUIRE(corridor_runs == 1);
+
+    for (auto const& r : pipeline.last_report()) {
+        REQUIRE(!r.cached);
+    }
+
+    SECTION("the same seed re-runs nothing") {
+        REQUIRE(same_categories(pipeline.generate(5), first));
+        REQUIRE(corridor_runs == 1);
+
+        for (auto const& r : pipeline.last_report()) {
+            REQUIRE(r.cached);
+        }
+    }
+
+    SECTION("another seed re-runs everything") {
+        pipeline.generate(6);
+        REQUIRE(corridor_runs == 2);
+        REQUIRE(!pipeline.last_report()[0].cached);
+    }
+
+    SECTION("a replaced stage re-runs with the stages after it") {
+        int rasterize_runs = 0;
+
+        //rooms drawn as floor only, without walls
+        pipeline.set_rasterize_stage([&](layout_pipeline::layout_t&, yama::random_t&
+                                       , layout_pipeline::rooms_t const& in, map& out) {
+            ++rasterize_runs;
+            for (auto const& room : in.rooms) {
+                out.fill_rect<map_property::category>(room, yama::tile_category::floor);
+            }
+        });
+
+        auto const second = pipeline.generate(5);
+        auto const& report = pipeline.last_report();
+
+        REQUIRE(rasterize_runs == 1);
+        REQUIRE(corridor_runs == 2);
+        REQUIRE(report[0].cached);
+        REQUIRE(report[1].cached);
+        REQUIRE(!report[2].cached);
+        REQUIRE(!report[3].cached);
+        REQUIRE(!report[4].cached);
+        REQUIRE(!same_categories(second, first));
+
+        //back to the default; the same level as the first time
+        pipeline.set_rasterize_stage(layout_pipeline::default_rasterize());
+        REQUIRE(same_categories(pipeline.generate(5), first));
+        REQUIRE(corridor_runs == 3);
+    }
+
+    SECTION("invalidating the last stage restores the map before it") {
+        pipeline.invalidate(layout_pipeline::stage::features);
+
+        REQUIRE(same_categories(pipeline.generate(5), first));
+        REQUIRE(corridor_runs == 1);
+        REQUIRE(!pipeline.last_report()[4].cached);
+    }
+}
@@ -0,0 +1,146 @@
+#include "pch.hpp"
+#include "level_cache.hpp"
+
+#include <catch/catch.hpp>
+
+#include <fstream>
+#include <cstdio>
+
+using yama::map;
+using yama::map_property;
+
+namespace {
+
+bool same_categories(map const& a, map const& b) {
+    if (a.width() != b.width() || a.height() != b.height()) {
+        return false;
+    }
+
+    for (int y = 0; y < a.height(); ++y) {
+        for (int x = 0; x < a.width(); ++x) {
+            if (a.get<map_property::category>(x, y) != b.get<map_property::category>(x, y)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool exists(std::string const& file_name) {
+    return !!std::ifstream {file_name};
+}
+
+} //namespace
+
+TEST_CASE("level keys", "[level_cache]") {
+    yama::bsp_layout::params_t params;
+
+    auto const key = yama::level_key(1, params);
+    REQUIRE(yama::level_key(1, params) == key);
+    REQUIRE(yama::level_key(2, params) != key);
+
+    params.room_generation_chance = 11;
+    REQUIRE(yama::level_key(1, params) != key);
+}
+
+TEST_CASE("level cache", "[level_cache]") {
+    yama::bsp_layout::params_t params;
+    params.map_w = 80;
+    params.map_h = 60;
+
+    auto const remove_all = [&] {
+        yama::level_cache cache {".", 0};
+        for (uint32_t seed = 1; seed <= 3; ++seed) {
+            std::remove(cache.file_name(yama::level_key(seed, params)).c_str());
+        }
+        std::remove("./level_cache.index");
+    };
+
+    remove_all();
+
+    auto const file_of = [&](yama::level_cache const& cache, uint32_t const seed) {
+        return cache.file_name(yama::level_key(seed, params));
+    };
+
+    uint64_t level_size = 0;
+
+    {
+        yama::level_cache cache {".", uint64_t {1} << 30};
+
+        yama::bsp_layout layout {params};
+        yama::random_t random {1};
+        auto const expected = layout.generate(random);
+
+        auto const miss = cache.get(1, params);
+        REQUIRE(cache.misses() == 1);
+        REQUIRE(exists(file_of(cache, 1)));
+        REQUIRE(same_categories(miss.level_map, expected));
+        REQUIRE(miss.regions == layout.get_regions());
+
+        auto const hit = cache.get(1, params);
+        REQUIRE(cache.hits() == 1);
+        REQUIRE(hit.level_map.is_read_only());
+        REQUIRE(same_categories(hit.level_map, expected));
+        REQUIRE(hit.regions == miss.regions);
+
+        level_size = cache.size();
+        REQUIRE(level_size > 0);
+    }
+
+    SECTION("least recently used levels are evicted") {
+        //room for two levels, not three
+        yama::level_cache cache {".", level_size * 5 / 2};
+
+        cache.get(2, params);
+        cache.get(1, params); //the hit makes 2 the least recently used
+        cache.get(3, params);
+
+        REQUIRE(cache.hits() == 1);
+        REQUIRE(cache.misses() == 2);
+        REQUIRE(cache.size() <= level_size * 5 / 2);
+
+        REQUIRE(exists(file_of(cache, 1)));
+        REQUIRE(!exists(file_of(cache, 2)));
+        REQUIRE(exists(file_of(cache, 3)));
+    }
+
+    SECTION("damaged files are regenerated") {
+        yama::level_cache cache {".", uint64_t {1} << 30};
+
+        {
+            std::ofstream out {file_of(cache, 1), std::ios::binary | std::ios::trunc};
+            out << "not a level";
+        }
+
+        auto const level = cache.get(1, params);
+        REQUIRE(cache.misses() == 1);
+        REQUIRE(level.level_map.width() == 80);
+        REQUIRE(yama::load_level_file(file_of(cache, 1)).level_map.height() == 60);
+    }
+
+    SECTION("a damaged index is rebuilt") {
+        {
+            std::ofstream out {"./level_cache.index", std::ios::binary | std::ios::trunc};
+
+            //the magic and version, then a huge tick and count
+            uint32_t const version = 1;
+            uint64_t const huge    = ~uint64_t {0} / 2;
+            out.write("YLVC", 4);
+            out.write(reinterpret_cast<char const*>(&version), sizeof(version));
+            out.write(reinterpret_cast<char const*>(&huge), sizeof(huge));
+            out.write(reinterpret_cast<char const*>(&huge), sizeof(huge));
+        }
+
+        yama::level_cache cache {".", uint64_t {1} << 30};
+
+        REQUIRE_NOTHROW(cache.get(1, params));
+        REQUIRE_NOTHROW(cache.get(2, params));
+        REQUIRE(cache.hits() == 1);
+        REQUIRE(cache.misses() == 1);
+        REQUIRE(cache.size() > 0);
+    }
+
+    remove_all();
+    std::remove("./level_cache.lock");
+}
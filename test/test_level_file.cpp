@@ -0,0 +1,157 @@
+#include "pch.hpp"
+#include "level_file.hpp"
+#include "map_journal.hpp"
+
+#include <catch/catch.hpp>
+
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <cstdio>
+
+using yama::map;
+using yama::map_property;
+using yama::tile_category;
+
+TEST_CASE("level file round trip", "[level_file]") {
+    constexpr int w = 70;
+    constexpr int h = 33;
+
+    char const* const file_name = "test_level_file.level";
+
+    map m {w, h};
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            m.set<map_property::category>(x, y, static_cast<tile_category>((x + y) % 6));
+            m.set<map_property::room_id>(x, y, static_cast<yama::room_id_t>(x * y));
+            m.set<map_property::texture_id>(x, y, static_cast<yama::texture_id_t>(x + 100));
+        }
+    }
+
+    std::vector<yama::rect_t> const regions {{0, 0, 35, 33}, {35, 0, 70, 20}, {35, 20, 70, 33}};
+
+    yama::save_level_file(file_name, m, regions);
+
+    {
+        auto const level = yama::load_level_file(file_name);
+        auto const& lm = level.level_map;
+
+        REQUIRE(lm.is_read_only());
+        REQUIRE(!m.is_read_only());
+        REQUIRE(lm.width()  == w);
+        REQUIRE(lm.height() == h);
+        REQUIRE(level.regions == regions);
+
+        for (int y = 0; y < h; ++y) {
+            for (int x = 0; x < w; ++x) {
+                REQUIRE(lm.get<map_property::category>(x, y)   == m.get<map_property::category>(x, y));
+                REQUIRE(lm.get<map_property::room_id>(x, y)    == m.get<map_property::room_id>(x, y));
+                REQUIRE(lm.get<map_property::texture_id>(x, y) == m.get<map_property::texture_id>(x, y));
+            }
+        }
+
+        //the loaded map can itself be saved
+        yama::save_level_file("test_level_file2.level", lm, level.regions);
+        auto const copy = yama::load_level_file("test_level_file2.level");
+        REQUIRE(copy.level_map.get<map_property::room_id>(w - 1, h - 1) == (w - 1) * (h - 1));
+    }
+
+    std::remove("test_level_file2.level");
+
+    SECTION("bad files are rejected") {
+        {
+            std::ofstream out {file_name, std::ios::binary | std::ios::trunc};
+            out << "not a level file at all, but long enough to hold a header......"
+                   "................................................................";
+        }
+
+        REQUIRE_THROWS(yama::load_level_file(file_name));
+    }
+
+    std::remove(file_name);
+}
+
+TEST_CASE("level delta round trip", "[level_file]") {
+    char const* const file_name = "test_level_file.delta";
+
+    uint32_t const seed = 1234;
+
+    yama::bsp_layout::params_t params;
+    params.map_w = 80;
+    params.map_h = 60;
+
+    yama::random_t random {seed};
+    auto m = yama::bsp_layout {params}.generate(random);
+
+    m.set_journaling(true);
+    m.fill_rect<map_property::category>(yama::rect_t {10, 10, 20, 12}, tile_category::door);
+    m.set<map_property::room_id>(1, 1, 99);
+
+    yama::save_level_delta(file_name, seed, params, m.journal());
+
+    auto const loaded = yama::load_level_delta(file_name);
+    REQUIRE(loaded.is_journaling());
+    REQUIRE(loaded.journal().deltas() == m.journal().deltas());
+
+    for (int y = 0; y < m.height(); ++y) {
+        for (int x = 0; x < m.width(); ++x) {
+            REQUIRE(loaded.get<map_property::category>(x, y) == m.get<map_property::category>(x, y));
+            REQUIRE(loaded.get<map_property::room_id>(x, y)  == m.get<map_property::room_id>(x, y));
+        }
+    }
+
+    //the generator version and the engine follow the magic and the version
+    for (auto const offset : {8, 12}) {
+        yama::save_level_delta(file_name, seed, params, m.journal());
+
+        {
+            std::fstream f {file_name, std::ios::in | std::ios::out | std::ios::binary};
+            uint32_t const other = 0xffffffffu;
+            f.seekp(offset);
+            f.write(reinterpret_cast<char const*>(&other), sizeof(other));
+        }
+
+        REQUIRE_THROWS(yama::load_level_delta(file_name));
+    }
+
+    //damaged or missing params throw rather than failing their checks
+    yama::save_level_delta(file_name, seed, params, m.journal());
+
+    std::string bytes;
+    {
+        std::ifstream in {file_name, std::ios::binary};
+        bytes.assign(std::istreambuf_iterator<char> {in}, std::istreambuf_iterator<char> {});
+    }
+
+    auto const load_with = [&](std::string const& contents) {
+        {
+            std::ofstream out {file_name, std::ios::binary | std::ios::trunc};
+            out.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+        }
+
+        return yama::load_level_delta(file_name);
+    };
+
+    auto const with_int_at = [&](size_t const offset, int32_t const value) {
+        auto result = bytes;
+        result.replace(offset, sizeof(value), reinterpret_cast<char const*>(&value), sizeof(value));
+        return result;
+    };
+
+    //the params follow the magic, version, generator, engine and seed
+    size_t const map_w_offset            = 20;
+    size_t const room_w_lower_offset     = 28;
+    size_t const room_size_weight_offset = 44;
+
+    REQUIRE_NOTHROW(load_with(bytes));
+    REQUIRE_THROWS_AS(load_with(with_int_at(map_w_offset, 5)), std::runtime_error);
+    REQUIRE_THROWS_AS(load_with(with_int_at(room_w_lower_offset, 100)), std::runtime_error);
+    REQUIRE_THROWS_AS(load_with(with_int_at(room_size_weight_offset, 1000)), std::runtime_error);
+
+    for (size_t const size : {size_t {20}, size_t {22}, size_t {48}}) {
+        REQUIRE_THROWS_AS(load_with(bytes.substr(0, size)), std::runtime_error);
+    }
+
+    std::remove(file_name);
+}
@@ -0,0 +1,70 @@
+#include "pch.hpp"
+#include "level_metrics.hpp"
+#include "bsp_layout.hpp"
+
+#include <catch/catch.hpp>
+
+using yama::map;
+using yama::map_property;
+using yama::tile_category;
+using yama::rect_t;
+
+TEST_CASE("level metrics", "[level_metrics]") {
+    map m {12, 10};
+    m.fill_rect<map_property::category>(rect_t {0, 0, 12, 10}, tile_category::wall);
+
+    //two rooms joined by a corridor with a dead end branching off it
+    m.fill_rect<map_property::category>(rect_t {1, 1, 4, 4},  tile_category::floor);
+    m.fill_rect<map_property::category>(rect_t {8, 1, 11, 4}, tile_category::floor);
+    m.fill_rect<map_property::category>(rect_t {4, 2, 8, 3},  tile_category::corridor);
+    m.fill_rect<map_property::category>(rect_t {5, 3, 6, 7},  tile_category::corridor);
+
+    m.set<map_property::category>(1, 1,  tile_category::stair);
+    m.set<map_property::category>(10, 3, tile_category::stair);
+
+    yama::level_analyzer analyzer;
+
+    auto const metrics = analyzer.analyze(m);
+    REQUIRE(metrics.stair_distance == 11);
+    REQUIRE(metrics.longest_dead_end == 4);
+
+    SECTION("disconnected stairs") {
+        m.set<map_property::category>(6, 2, tile_category::wall);
+
+        auto const cut = analyzer.analyze(m);
+        REQUIRE(cut.stair_distance == -1);
+
+        //the branch now runs on, past the cut, to the left room
+        REQUIRE(cut.longest_dead_end == 6);
+    }
+
+    SECTION("a single stair") {
+        m.set<map_property::category>(10, 3, tile_category::floor);
+        REQUIRE(analyzer.analyze(m).stair_distance == -1);
+    }
+}
+
+TEST_CASE("level metrics of generated levels", "[level_metrics]") {
+    yama::bsp_layout::params_t params;
+    params.map_w = 100;
+    params.map_h = 80;
+    params.route_corridors = true;
+
+    yama::bsp_layout layout {params};
+    yama::level_analyzer analyzer;
+
+    for (uint32_t seed = 0; seed < 20; ++seed) {
+        yama::random_t random {seed};
+        auto const m = layout.generate(random);
+
+        auto const metrics = analyzer.analyze(m);
+
+        //routed corridors connect every room
+        if (layout.get_rooms().size() > 1) {
+            REQUIRE(metrics.stair_distance > 0);
+        }
+
+        //a fresh analyzer agrees with a reused one
+        REQUIRE(yama::level_analyzer {}.analyze(m).stair_distance == metrics.stair_distance);
+    }
+}
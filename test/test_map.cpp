@@ -0,0 +1,116 @@
+#include "pch.hpp"
+#include "map.hpp"
+
+#include <catch/catch.hpp>
+
+using yama::map;
+using yama::map_property;
+using yama::tile_category;
+
+TEST_CASE("map properties are independent", "[map]") {
+    constexpr int w = 20;
+    constexpr int h = 15;
+
+    map m {w, h};
+
+    REQUIRE(m.width()  == w);
+    REQUIRE(m.height() == h);
+
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            m.set<map_property::category>(x, y, tile_category::floor);
+            m.set<map_property::room_id>(x, y, static_cast<yama::room_id_t>(x + y*w));
+            m.set<map_property::texture_id>(x, y, static_cast<yama::texture_id_t>(1000 + x));
+        }
+    }
+
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            REQUIRE(m.get<map_property::category>(x, y) == tile_category::floor);
+            REQUIRE(m.get<map_property::room_id>(x, y) == x + y*w);
+            REQUIRE(m.get<map_property::texture_id>(x, y) == 1000 + x);
+        }
+    }
+
+    SECTION("rows") {
+        std::vector<yama::room_id_t> row (w);
+        m.read_row<map_property::room_id>(3, row.data());
+
+        for (int x = 0; x < w; ++x) {
+            REQUIRE(row[x] == x + 3*w);
+        }
+    }
+
+    SECTION("clear") {
+        m.clear();
+
+        REQUIRE(m.get<map_property::category>(1, 1)   == tile_category::empty);
+        REQUIRE(m.get<map_property::room_id>(1, 1)    == 0);
+        REQUIRE(m.get<map_property::texture_id>(1, 1) == 0);
+    }
+}
+
+TEST_CASE("map bulk operations", "[map]") {
+    constexpr int w = 40;
+    constexpr int h = 12;
+
+    map m {w, h};
+
+    yama::rect_t const r {3, 2, 37, 9};
+
+    SECTION("fill_rect") {
+        m.fill_rect<map_property::category>(r, tile_category::wall);
+
+        auto const v = m.view<map_property::category>();
+        for (int y = 0; y < h; ++y) {
+            for (int x = 0; x < w; ++x) {
+                auto const expected = r.contains(x, y) ? tile_category::wall : tile_category::empty;
+                REQUIRE(v(x, y) == expected);
+                REQUIRE(m.get<map_property::category>(x, y) == expected);
+            }
+        }
+    }
+
+    SECTION("write_rect and read_rect") {
+        std::vector<tile_category>   cats  (r.area());
+        std::vector<yama::room_id_t> rooms (r.area());
+
+        for (size_t i = 0; i < cats.size(); ++i) {
+            cats[i]  = static_cast<tile_category>(i % 6);
+            rooms[i] = static_cast<yama::room_id_t>(i);
+        }
+
+        m.write_rect<map_property::category>(r, cats.data());
+        m.write_rect<map_property::room_id>(r, rooms.data());
+
+        for (int y = r.top; y < r.bottom; ++y) {
+            for (int x = r.left; x < r.right; ++x) {
+                auto const i = (x - r.left) + (y - r.top) * r.width();
+                REQUIRE(m.get<map_property::category>(x, y) == cats[i]);
+                REQUIRE(m.get<map_property::room_id>(x, y) == rooms[i]);
+            }
+        }
+
+        std::vector<tile_category>   cats_out  (r.area());
+        std::vector<yama::room_id_t> rooms_out (r.area());
+
+        m.read_rect<map_property::category>(r, cats_out.data());
+        m.read_rect<map_property::room_id>(r, rooms_out.data());
+
+        REQUIRE(cats_out  == cats);
+        REQUIRE(rooms_out == rooms);
+
+        REQUIRE(m.get<map_property::category>(r.left - 1, r.top) == tile_category::empty);
+        REQUIRE(m.get<map_property::category>(r.right, r.top)    == tile_category::empty);
+    }
+
+    SECTION("views expose rows") {
+        m.set<map_property::texture_id>(5, 4, 77);
+
+        auto const v = m.view<map_property::texture_id>();
+        REQUIRE(v.width()  == w);
+        REQUIRE(v.height() == h);
+        REQUIRE(v.row(4)[5] == 77);
+        REQUIRE(v(5, 4) == 77);
+    }
+}
@@ -0,0 +1,138 @@
+#include "pch.hpp"
+#include "map_journal.hpp"
+
+#include <catch/catch.hpp>
+
+#include <sstream>
+
+using yama::map;
+using yama::map_delta;
+using yama::map_journal;
+using yama::map_property;
+using yama::tile_category;
+
+TEST_CASE("map_journal coalesces runs", "[map_journal]") {
+    map_journal j;
+
+    j.record<map_property::category>(3, 2, tile_category::wall, tile_category::floor);
+    j.record<map_property::category>(4, 2, tile_category::wall, tile_category::floor);
+    j.record<map_property::category>(5, 2, tile_category::wall, tile_category::floor);
+
+    //no change; not recorded
+    j.record<map_property::category>(6, 2, tile_category::wall, tile_category::wall);
+
+    //a different old value starts a new run
+    j.record<map_property::category>(6, 2, tile_category::empty, tile_category::floor);
+
+    //a different property starts a new run
+    j.record<map_property::room_id>(7, 2, 0, 1);
+
+    REQUIRE(j.size() == 3);
+    REQUIRE(j.deltas()[0] == (map_delta {3, 2, 3, map_property::category
+      , static_cast<uint32_t>(tile_category::wall), static_cast<uint32_t>(tile_category::floor)}));
+    REQUIRE(j.deltas()[1].x == 6);
+    REQUIRE(j.deltas()[2].property == map_property::room_id);
+
+    SECTION("write and read") {
+        std::stringstream stream;
+        j.write(stream);
+
+        map_journal j2;
+        REQUIRE(j2.read(stream, 8, 3));
+        REQUIRE(j2.deltas() == j.deltas());
+    }
+
+    SECTION("runs outside the map are malformed") {
+        std::stringstream stream;
+        j.write(stream);
+
+        map_journal j2;
+        REQUIRE(!j2.read(stream, 7, 3));
+        REQUIRE(j2.empty());
+    }
+}
+
+TEST_CASE("map_journal rejects malformed input", "[map_journal]") {
+    auto const reads = [](map_delta const& d) {
+        map_journal j;
+        j.record(d.property, d.x, d.y, d.old_value, d.new_value);
+
+        //patch the recorded run to the one under test
+        std::stringstream stream;
+        j.write(stream);
+        auto bytes = stream.str();
+
+        int32_t const xyc[] = {d.x, d.y, d.count};
+        bytes.replace(4 + 1, sizeof(xyc), reinterpret_cast<char const*>(xyc), sizeof(xyc));
+
+        std::stringstream patched {bytes};
+        return map_journal {}.read(patched, 100, 100);
+    };
+
+    auto const category = map_property::category;
+    auto const room_id  = map_property::room_id;
+
+    REQUIRE(reads(map_delta {0, 0, 100, category, 1, 2}));
+    REQUIRE(reads(map_delta {99, 99, 1, room_id, 0, 0xffff}));
+
+    //values that don't fit the 4 bit category or the 16 bit room id
+    REQUIRE(!reads(map_delta {0, 0, 1, category, 1, 16}));
+    REQUIRE(!reads(map_delta {0, 0, 1, category, 16, 1}));
+    REQUIRE(!reads(map_delta {0, 0, 1, room_id, 0, 0x10000}));
+
+    //runs off the map, empty, or whose end overflows
+    REQUIRE(!reads(map_delta {-1, 0, 1, category, 1, 2}));
+    REQUIRE(!reads(map_delta {0, 100, 1, category, 1, 2}));
+    REQUIRE(!reads(map_delta {0, 0, 101, category, 1, 2}));
+    REQUIRE(!reads(map_delta {0, 0, 0, category, 1, 2}));
+    REQUIRE(!reads(map_delta {50, 0, 0x7fffffff, category, 1, 2}));
+}
+
+TEST_CASE("map journaling", "[map_journal]") {
+    map m {40, 30};
+    m.fill_rect<map_property::category>(yama::rect_t {0, 0, 40, 30}, tile_category::wall);
+
+    map copy {40, 30};
+    copy.fill_rect<map_property::category>(yama::rect_t {0, 0, 40, 30}, tile_category::wall);
+
+    REQUIRE(!m.is_journaling());
+    m.set_journaling(true);
+
+    m.fill_rect<map_property::category>(yama::rect_t {2, 3, 12, 8}, tile_category::floor);
+    m.set<map_property::category>(20, 20, tile_category::door);
+    m.set<map_property::room_id>(5, 5, 7);
+
+    std::vector<yama::texture_id_t> const textures {1, 1, 1, 2, 2};
+    m.write_rect<map_property::texture_id>(yama::rect_t {0, 0, 5, 1}, textures.data());
+
+    //one run per row of the fill, then the door, room and two texture runs
+    REQUIRE(m.journal().size() == 5 + 1 + 1 + 2);
+
+    m.set_journaling(false);
+    m.set<map_property::category>(0, 0, tile_category::floor);
+    REQUIRE(m.journal().size() == 9);
+
+    REQUIRE(m.journal().replay(copy));
+    REQUIRE(copy.get<map_property::category>(2, 3)   == tile_category::floor);
+    REQUIRE(copy.get<map_property::category>(11, 7)  == tile_category::floor);
+    REQUIRE(copy.get<map_property::category>(12, 7)  == tile_category::wall);
+    REQUIRE(copy.get<map_property::category>(20, 20) == tile_category::door);
+    REQUIRE(copy.get<map_property::category>(0, 0)   == tile_category::wall);
+    REQUIRE(copy.get<map_property::room_id>(5, 5)    == 7);
+    REQUIRE(copy.get<map_property::texture_id>(4, 0) == 2);
+
+    //replaying again fails; the old values no longer match
+    REQUIRE(!m.journal().replay(copy));
+}
+
+TEST_CASE("map journaling clear", "[map_journal]") {
+    map m {20, 20};
+    m.set<map_property::category>(3, 3, tile_category::floor);
+    m.set<map_property::room_id>(4, 4, 2);
+
+    m.set_journaling(true);
+    m.clear();
+
+    REQUIRE(m.get<map_property::category>(3, 3) == tile_category::empty);
+    REQUIRE(m.journal().size() == 2);
+}
@@ -0,0 +1,119 @@
+#include "pch.hpp"
+#include "packed_grid.hpp"
+#include "tile.hpp"
+
+#include <catch/catch.hpp>
+
+TEST_CASE("packed grid can be initialized and cleared", "[packed_grid]") {
+    using yama::tile_category;
+    using grid_t = yama::packed_grid<tile_category, 4>;
+
+    constexpr int w = 37;
+    constexpr int h = 5;
+
+    grid_t grid {w, h, tile_category::wall};
+
+    auto const check_values = [](grid_t const& g, tile_category const check_value) {
+        yama::for_each_xy(g, [&](int x, int y, tile_category val) {
+            REQUIRE(g(x, y) == val);
+            REQUIRE(val == check_value);
+        });
+    };
+
+    SECTION("dimensions") {
+        REQUIRE(grid.width()  == w);
+        REQUIRE(grid.height() == h);
+    }
+
+    SECTION("chosen default value") {
+        check_values(grid, tile_category::wall);
+    }
+
+    SECTION("clear to value") {
+        grid.clear(tile_category::invalid);
+        check_values(grid, tile_category::invalid);
+    }
+
+    SECTION("clear to default") {
+        grid.clear();
+        check_values(grid, tile_category {});
+    }
+}
+
+TEST_CASE("packed grid writes are masked", "[packed_grid]") {
+    constexpr int w = 70;
+    constexpr int h = 3;
+
+    yama::packed_grid<uint8_t, 2> grid {w, h};
+
+    auto const value_at = [](int const x, int const y) {
+        return static_cast<uint8_t>((x * 7 + y) & 3);
+    };
+
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            grid.set(x, y, value_at(x, y));
+        }
+    }
+
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            REQUIRE(grid(x, y) == value_at(x, y));
+        }
+    }
+
+    SECTION("decode whole rows") {
+        std::vector<uint8_t> row (w);
+
+        for (int y = 0; y < h; ++y) {
+            grid.decode_row(y, row.data());
+            for (int x = 0; x < w; ++x) {
+                REQUIRE(row[x] == value_at(x, y));
+            }
+        }
+    }
+
+    SECTION("decode partial rows") {
+        constexpr int x0 = 5;
+        constexpr int x1 = 67;
+
+        std::vector<uint8_t> row (x1 - x0);
+        grid.decode_row(1, x0, x1, row.data());
+
+        for (int x = x0; x < x1; ++x) {
+            REQUIRE(row[x - x0] == value_at(x, 1));
+        }
+    }
+
+    SECTION("encode and fill spans leave other values alone") {
+        //spans within a word, across words and ending on word boundaries
+        int const spans[][2] = {{0, 0}, {3, 9}, {0, 32}, {30, 34}, {5, 67}, {32, 64}, {63, 70}};
+
+        std::vector<uint8_t> in (w);
+
+        for (auto const& span : spans) {
+            auto const x0 = span[0];
+            auto const x1 = span[1];
+
+            for (int x = x0; x < x1; ++x) {
+                in[x - x0] = static_cast<uint8_t>(3 - value_at(x, 1));
+            }
+
+            grid.encode_row(1, x0, x1, in.data());
+            grid.fill_row(2, x0, x1, 3);
+
+            for (int x = 0; x < w; ++x) {
+                auto const inside = x >= x0 && x < x1;
+                REQUIRE(grid(x, 0) == value_at(x, 0));
+                REQUIRE(grid(x, 1) == (inside ? 3 - value_at(x, 1) : value_at(x, 1)));
+                REQUIRE(grid(x, 2) == (inside ? 3 : value_at(x, 2)));
+            }
+
+            //restore
+            for (int x = x0; x < x1; ++x) {
+                grid.set(x, 1, value_at(x, 1));
+                grid.set(x, 2, value_at(x, 2));
+            }
+        }
+    }
+}
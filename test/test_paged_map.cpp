@@ -0,0 +1,154 @@
+#include "pch.hpp"
+#include "paged_map.hpp"
+#include "random.hpp"
+#include "cave_layout.hpp"
+
+#include <catch/catch.hpp>
+
+#include <stdexcept>
+#include <vector>
+
+using yama::map;
+using yama::paged_map;
+using yama::map_property;
+using yama::tile_category;
+
+TEST_CASE("paged_map unallocated chunks read as empty", "[paged_map]") {
+    paged_map m {1000, 800, 4 * 1024 * 1024, "test_paged_map.swap"};
+
+    REQUIRE(m.width()  == 1000);
+    REQUIRE(m.height() == 800);
+    REQUIRE(m.allocated_chunks() == 0);
+
+    REQUIRE(m.get<map_property::category>(999, 799) == tile_category::empty);
+    REQUIRE(m.get<map_property::room_id>(0, 0) == 0);
+
+    //writing the default value doesn't allocate
+    m.set<map_property::category>(10, 10, tile_category::empty);
+    REQUIRE(m.allocated_chunks() == 0);
+
+    m.set<map_property::category>(10, 10, tile_category::floor);
+    REQUIRE(m.allocated_chunks() == 1);
+    REQUIRE(m.get<map_property::category>(10, 10) == tile_category::floor);
+    REQUIRE(m.get<map_property::category>(11, 10) == tile_category::empty);
+
+    m.clear();
+    REQUIRE(m.allocated_chunks() == 0);
+    REQUIRE(m.get<map_property::category>(10, 10) == tile_category::empty);
+}
+
+TEST_CASE("paged_map evicts to disk under its memory budget", "[paged_map]") {
+    constexpr int w = 512;
+    constexpr int h = 384;
+
+    //a budget of only two chunks
+    auto const budget = paged_map::chunk_bytes() * 2;
+
+    paged_map m {w, h, budget, "test_paged_map.swap"};
+
+    auto const value_at = [](int const x, int const y) {
+        return static_cast<yama::room_id_t>((x * 31 + y * 17) & 0xFFFF);
+    };
+
+    for (int y = 0; y < h; y += 7) {
+        for (int x = 0; x < w; x += 5) {
+            m.set<map_property::room_id>(x, y, value_at(x, y));
+            m.set<map_property::texture_id>(x, y, static_cast<yama::texture_id_t>(x));
+            REQUIRE(m.resident_chunks() <= 2);
+        }
+    }
+
+    REQUIRE(m.allocated_chunks() == (w / paged_map::chunk_size) * (h / paged_map::chunk_size));
+
+    for (int y = 0; y < h; y += 7) {
+        for (int x = 0; x < w; x += 5) {
+            REQUIRE(m.get<map_property::room_id>(x, y) == value_at(x, y));
+            REQUIRE(m.get<map_property::texture_id>(x, y) == x);
+            REQUIRE(m.get<map_property::category>(x, y) == tile_category::empty);
+        }
+    }
+
+    REQUIRE(m.resident_chunks() <= 2);
+}
+
+TEST_CASE("paged_map blit", "[paged_map]") {
+    map source {20, 10};
+    source.fill_rect<map_property::category>(yama::rect_t {0, 0, 20, 10}, tile_category::wall);
+    source.set<map_property::room_id>(3, 4, 42);
+
+    paged_map m {300, 300, 1024 * 1024, "test_paged_map.swap"};
+    m.blit(source, 60, 120);
+
+    REQUIRE(m.get<map_property::category>(59, 120) == tile_category::empty);
+    REQUIRE(m.get<map_property::category>(60, 120) == tile_category::wall);
+    REQUIRE(m.get<map_property::category>(79, 129) == tile_category::wall);
+    REQUIRE(m.get<map_property::category>(80, 129) == tile_category::empty);
+    REQUIRE(m.get<map_property::room_id>(63, 124) == 42);
+
+    //the source straddles chunk boundaries
+    REQUIRE(m.allocated_chunks() == 4);
+}
+
+TEST_CASE("paged_map extract", "[paged_map]") {
+    paged_map m {300, 300, paged_map::chunk_bytes() * 2, "test_paged_map.swap"};
+
+    //generate into a region, as code taking a map would, and write it back
+    yama::rect_t const r {50, 100, 150, 160};
+    auto region = m.extract(r);
+    REQUIRE(region.width() == 100);
+    REQUIRE(region.height() == 60);
+    REQUIRE(region.get<map_property::category>(0, 0) == tile_category::empty);
+
+    yama::cave_layout::params_t params;
+    params.map_w = r.width();
+    params.map_h = r.height();
+
+    yama::random_t random {9};
+    yama::cave_layout {params}.generate_into(region, random);
+    region.set<map_property::room_id>(99, 59, 7);
+    m.blit(region, r.left, r.top);
+
+    //the region round trips across chunks, some of them swapped out
+    auto const copy = m.extract(r);
+    for (int y = 0; y < r.height(); ++y) {
+        for (int x = 0; x < r.width(); ++x) {
+            REQUIRE(copy.get<map_property::category>(x, y) == region.get<map_property::category>(x, y));
+            REQUIRE(copy.get<map_property::room_id>(x, y) == region.get<map_property::room_id>(x, y));
+        }
+    }
+
+    //unallocated chunks read as empty
+    auto const corner = m.extract(yama::rect_t {r.left - 10, r.top - 10, r.left + 10, r.top + 10});
+    REQUIRE(corner.get<map_property::category>(0, 0) == tile_category::empty);
+    REQUIRE(corner.get<map_property::category>(10, 10) == tile_category::wall);
+}
+
+TEST_CASE("paged_map throws if the swap file can't be created", "[paged_map]") {
+    REQUIRE_THROWS_AS(
+        (paged_map {100, 100, 1024 * 1024, "no_such_directory/test_paged_map.swap"})
+      , std::runtime_error);
+}
+
+TEST_CASE("paged_map random access under its memory budget", "[paged_map]") {
+    constexpr int w = paged_map::chunk_size * 4;
+    constexpr int h = paged_map::chunk_size * 4;
+
+    paged_map m {w, h, paged_map::chunk_bytes() * 3, "test_paged_map.swap"};
+    std::vector<yama::room_id_t> expected (w * h);
+
+    yama::random_t random {5};
+    for (int i = 0; i < 20000; ++i) {
+        auto const x = yama::random_uniform(random, 0, w - 1);
+        auto const y = yama::random_uniform(random, 0, h - 1);
+        auto& value = expected[static_cast<size_t>(x + y * w)];
+
+        if (yama::random_bool(random)) {
+            value = static_cast<yama::room_id_t>(i);
+            m.set<map_property::room_id>(x, y, value);
+        } else {
+            REQUIRE(m.get<map_property::room_id>(x, y) == value);
+        }
+
+        REQUIRE(m.resident_chunks() <= 3);
+    }
+}
@@ -0,0 +1,138 @@
+#include "pch.hpp"
+#include "random.hpp"
+
+#include <catch/catch.hpp>
+
+#include <limits>
+#include <random>
+#include <vector>
+
+TEST_CASE("bounded random values are the same everywhere", "[random]") {
+    //from std::mt19937, whose values the standard specifies, whatever
+    //engine random_t is
+    std::mt19937 random {1002};
+
+    std::vector<int> dice;
+    for (int i = 0; i < 8; ++i) {
+        dice.push_back(yama::random_uniform(random, 1, 6));
+    }
+    REQUIRE(dice == (std::vector<int> {1, 1, 3, 1, 3, 1, 4, 6}));
+
+    std::vector<int> percents;
+    for (int i = 0; i < 8; ++i) {
+        percents.push_back(yama::random_percent(random));
+    }
+    REQUIRE(percents == (std::vector<int> {18, 33, 42, 89, 13, 53, 66, 24}));
+
+    std::vector<int> wide;
+    for (int i = 0; i < 8; ++i) {
+        wide.push_back(yama::random_uniform(random, -1000000, 1000000000));
+    }
+    REQUIRE(wide == (std::vector<int> {
+        906254966, 137280096, 913051492, 349735124, 342544345, 614130321, 215593531, 550831569
+    }));
+}
+
+TEST_CASE("bounded random ranges", "[random]") {
+    yama::random_t random {7};
+
+    SECTION("single values and the full range") {
+        REQUIRE(yama::random_uniform(random, 5, 5) == 5);
+        REQUIRE(yama::random_uniform(random, -3, -3) == -3);
+
+        auto const lo = std::numeric_limits<int>::min();
+        auto const hi = std::numeric_limits<int>::max();
+        bool negative = false;
+        bool positive = false;
+        for (int i = 0; i < 64; ++i) {
+            auto const n = yama::random_uniform(random, lo, hi);
+            negative |= n < 0;
+            positive |= n > 0;
+        }
+        REQUIRE((negative && positive));
+    }
+
+    SECTION("every value is reached, and nothing outside") {
+        int counts[7] = {};
+        for (int i = 0; i < 7000; ++i) {
+            auto const n = yama::random_uniform(random, -3, 3);
+            REQUIRE(n >= -3);
+            REQUIRE(n <= 3);
+            ++counts[n + 3];
+        }
+        for (auto const n : counts) {
+            REQUIRE(n > 850);
+            REQUIRE(n < 1150);
+        }
+    }
+
+    SECTION("the batch gives the same values as single calls") {
+        for (auto const hi : {1, 6, 100, 1 << 30}) {
+            auto copy = random;
+
+            std::vector<int> batch (100);
+            yama::random_uniform_n(random, 0, hi, batch.data(), batch.size());
+
+            for (auto const n : batch) {
+                REQUIRE(yama::random_uniform(copy, 0, hi) == n);
+            }
+            REQUIRE(copy == random);
+        }
+    }
+}
+
+TEST_CASE("philox known answers", "[random]") {
+    using c = yama::philox4x32::counter_t;
+
+    REQUIRE(yama::philox4x32 {{{0, 0}}}(c {{0, 0, 0, 0}})
+        == (c {{0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u}}));
+
+    REQUIRE(yama::philox4x32 {{{0xa4093822u, 0x299f31d0u}}}(c {{0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u}})
+        == (c {{0xd16cfe09u, 0x94fdccebu, 0x5001e420u, 0x24126ea1u}}));
+}
+
+TEST_CASE("hash random", "[random]") {
+    uint64_t const seed = 0x123456789abcdefull;
+
+    SECTION("rows are the tiles one at a time") {
+        for (int const x : {0, 1, 3, -7, 1000}) {
+            for (size_t const n : {size_t {0}, size_t {1}, size_t {5}, size_t {64}, size_t {203}}) {
+                std::vector<uint32_t> row (n);
+                yama::hash_random_row(seed, x, -3, 9, row.data(), n);
+
+                for (size_t i = 0; i < n; ++i) {
+                    REQUIRE(row[i] == yama::hash_random(seed, x + static_cast<int>(i), -3, 9));
+                }
+            }
+        }
+    }
+
+    SECTION("seeds, positions and purposes give other values") {
+        auto const v = yama::hash_random(seed, 10, 20, 1);
+        REQUIRE(yama::hash_random(seed, 10, 20, 1) == v);
+        REQUIRE(yama::hash_random(seed + 1, 10, 20, 1) != v);
+        REQUIRE(yama::hash_random(seed ^ (uint64_t {1} << 40), 10, 20, 1) != v);
+        REQUIRE(yama::hash_random(seed, 11, 20, 1) != v);
+        REQUIRE(yama::hash_random(seed, 10, 21, 1) != v);
+        REQUIRE(yama::hash_random(seed, 10, 20, 2) != v);
+    }
+
+    SECTION("every bit is set about half the time") {
+        int counts[32] = {};
+        int const n = 64 * 64;
+
+        for (int y = 0; y < 64; ++y) {
+            for (int x = 0; x < 64; ++x) {
+                auto const v = yama::hash_random(seed, x, y, 0);
+                for (int b = 0; b < 32; ++b) {
+                    counts[b] += (v >> b) & 1;
+                }
+            }
+        }
+
+        for (auto const k : counts) {
+            REQUIRE(k > n / 2 - 200);
+            REQUIRE(k < n / 2 + 200);
+        }
+    }
+}
@@ -0,0 +1,102 @@
+#include "pch.hpp"
+#include "random.hpp"
+
+#include <catch/catch.hpp>
+
+#include <vector>
+
+using yama::xoshiro256ss;
+using yama::pcg64;
+
+namespace {
+
+template <typename Engine>
+std::vector<uint64_t> values_of(Engine e, size_t const n = 16) {
+    std::vector<uint64_t> result;
+    for (size_t i = 0; i < n; ++i) {
+        result.push_back(e());
+    }
+    return result;
+}
+
+template <typename Engine>
+void check_engine() {
+    Engine const e {42};
+
+    //seeding is deterministic and seeds differ
+    REQUIRE(values_of(e) == values_of(Engine {42}));
+    REQUIRE(values_of(e) != values_of(Engine {43}));
+
+    //the state round trips
+    auto a = e;
+    a.discard(100);
+    Engine b {a.state()};
+    REQUIRE(a == b);
+    REQUIRE(values_of(a) == values_of(b));
+
+    //discard(n) is n calls
+    auto c = e;
+    for (int i = 0; i < 100; ++i) {
+        c();
+    }
+    REQUIRE(c == a);
+
+    //jumps and splits give new streams without changing the source
+    auto j = e;
+    j.jump();
+    REQUIRE(values_of(j) != values_of(e));
+
+    auto const s1 = e.split(1);
+    auto const s2 = e.split(2);
+    REQUIRE(values_of(e.split(1)) == values_of(s1));
+    REQUIRE(values_of(s1) != values_of(s2));
+    REQUIRE(values_of(s1) != values_of(e));
+    REQUIRE(e == Engine {42});
+
+    //usable with the std distributions; roughly uniform
+    Engine r {7};
+    int counts[10] = {};
+    for (int i = 0; i < 10000; ++i) {
+        ++counts[yama::random_uniform(r, 0, 9)];
+    }
+    for (auto const n : counts) {
+        REQUIRE(n > 850);
+        REQUIRE(n < 1150);
+    }
+}
+
+} //namespace
+
+TEST_CASE("xoshiro256**", "[random]") {
+    check_engine<xoshiro256ss>();
+
+    //the reference algorithm from a known state
+    xoshiro256ss e {xoshiro256ss::state_t {{1, 2, 3, 4}}};
+    REQUIRE(e() == 11520u);
+    REQUIRE(e() == 0u);
+}
+
+TEST_CASE("pcg64", "[random]") {
+    check_engine<pcg64>();
+
+    //streams of the same seed differ
+    REQUIRE(values_of(pcg64 {1, 1}) != values_of(pcg64 {1, 2}));
+
+    //discard in O(log n) agrees with stepping
+    pcg64 a {3};
+    pcg64 b {3};
+    a.discard(1000);
+    for (int i = 0; i < 1000; ++i) {
+        b();
+    }
+    REQUIRE(a == b);
+
+    //a jump is 2^64 steps: two halves of 2^63
+    pcg64 j {3};
+    j.jump();
+
+    pcg64 h {3};
+    h.discard(uint64_t {1} << 63);
+    h.discard(uint64_t {1} << 63);
+    REQUIRE(j == h);
+}
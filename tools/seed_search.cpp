@@ -0,0 +1,408 @@
+#include "pch.hpp"
+#include "bsp_layout.hpp"
+#include "level_metrics.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <mutex>
+#include <thread>
+
+using namespace yama;
+
+namespace {
+
+//! seeds are searched, and results written, in blocks of this many.
+uint32_t const block_size = 4096;
+
+char const results_magic[4] = {'Y', 'S', 'D', 'S'};
+
+uint32_t const results_version = 2;
+
+////////////////////////////////////////////////////////////////////////////////
+//! What is searched for; the results file starts with it, so a search is only
+//! resumed with the same query.
+////////////////////////////////////////////////////////////////////////////////
+struct query_t {
+    char     magic[4];
+    uint32_t version;
+    uint32_t generator_version;
+    uint32_t random_engine;
+    uint32_t first_seed;
+    uint32_t reserved;
+    uint64_t seed_count;
+    int32_t  width;
+    int32_t  height;
+    int32_t  min_rooms;
+    int32_t  max_rooms;
+    int32_t  min_stair_distance;
+    int32_t  max_dead_end;
+    uint32_t route_corridors;
+    uint32_t block_size;
+};
+
+//! precedes the matches of each searched block; the blocks are the index.
+struct block_header {
+    uint64_t block;
+    uint32_t match_count;
+    uint32_t reserved;
+};
+
+struct match_t {
+    uint32_t seed;
+    int32_t  room_count;
+    int32_t  stair_distance;
+    int32_t  longest_dead_end;
+};
+
+static_assert(sizeof(query_t) == 64, "");
+static_assert(sizeof(block_header) == 16, "");
+static_assert(sizeof(match_t) == 16, "");
+
+//! @p room_count is the layout's; the metrics are of the map alone.
+bool matches(query_t const& q, int const room_count, level_metrics const& m) {
+    return room_count >= q.min_rooms
+        && room_count <= q.max_rooms
+        && m.stair_distance >= q.min_stair_distance
+        && m.longest_dead_end <= q.max_dead_end;
+}
+
+uint64_t block_count(query_t const& q) {
+    return (q.seed_count + block_size - 1) / block_size;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+//! Read the blocks already searched from @p file_name into @p done and
+//! @p found; returns the size of the valid part of the file, 0 if it doesn't
+//! exist. A block cut short by an interruption isn't counted.
+//!
+//! Throws std::runtime_error if the file is for another query.
+////////////////////////////////////////////////////////////////////////////////
+uint64_t read_results(
+    std::string const&    file_name
+  , query_t const&        q
+  , std::vector<bool>&    done
+  , std::vector<match_t>& found
+) {
+    std::ifstream in {file_name, std::ios::in | std::ios::binary};
+
+    //missing, or interrupted before anything was written
+    if (!in || in.peek() == std::ifstream::traits_type::eof()) {
+        return 0;
+    }
+
+    query_t header {};
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+    if (!in || std::memcmp(&header, &q, sizeof(q)) != 0) {
+        throw std::runtime_error {"\"" + file_name + "\" holds the results of another search"};
+    }
+
+    auto valid = static_cast<uint64_t>(sizeof(header));
+
+    for (;;) {
+        block_header b {};
+        in.read(reinterpret_cast<char*>(&b), sizeof(b));
+
+        if (!in || b.block >= done.size()) {
+            break;
+        }
+
+        std::vector<match_t> block (b.match_count);
+        in.read(reinterpret_cast<char*>(block.data()), static_cast<std::streamsize>(sizeof(match_t) * block.size()));
+
+        if (!in) {
+            break;
+        }
+
+        done[static_cast<size_t>(b.block)] = true;
+        found.insert(found.end(), block.begin(), block.end());
+        valid += sizeof(b) + sizeof(match_t) * block.size();
+    }
+
+    return valid;
+}
+
+//! drop whatever follows the first @p size bytes of @p file_name.
+void truncate_results(std::string const& file_name, uint64_t const size) {
+    std::vector<char> data (static_cast<size_t>(size));
+
+    {
+        std::ifstream in {file_name, std::ios::in | std::ios::binary};
+        in.read(data.data(), static_cast<std::streamsize>(data.size()));
+    }
+
+    auto const temp = file_name + ".tmp";
+
+    {
+        std::ofstream out {temp, std::ios::out | std::ios::binary | std::ios::trunc};
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+        if (!out) {
+            throw std::runtime_error {"couldn't write \"" + temp + "\""};
+        }
+    }
+
+    std::remove(file_name.c_str());
+    if (std::rename(temp.c_str(), file_name.c_str()) != 0) {
+        throw std::runtime_error {"couldn't replace \"" + file_name + "\""};
+    }
+}
+
+void print_match(match_t const& m) {
+    std::cout << std::setw(10) << m.seed
+              << std::setw(8)  << m.room_count
+              << std::setw(8)  << m.stair_distance
+              << std::setw(8)  << m.longest_dead_end << "\n";
+}
+
+void print_usage() {
+    std::cerr <<
+        "usage: seed_search results_file [options]\n"
+        "  --seeds first count   the seeds to search (0 1000000)\n"
+        "  --size w h            the map size (64 64)\n"
+        "  --rooms min max       the allowed number of rooms\n"
+        "  --stairs n            the minimum steps between the stairs\n"
+        "  --dead-end n          the maximum dead end corridor length\n"
+        "  --routed              route corridors instead of random walks\n"
+        "  --threads n           0 for one per core (0)\n"
+        "  --list                print the matches found so far and exit\n"
+        "An interrupted search is resumed by running it again.\n";
+}
+
+} //namespace
+
+//==============================================================================
+//! Entry point: seed_search results_file [options]
+//!
+//! Searches seeds for levels meeting the given constraints on all cores,
+//! appending each finished block of seeds and its matches to results_file.
+//==============================================================================
+int SDL_main(int argc, char* argv[]) {
+    if (argc < 2) {
+        print_usage();
+        return 1;
+    }
+
+    std::string const file_name = argv[1];
+
+    query_t q {};
+    std::memcpy(q.magic, results_magic, sizeof(q.magic));
+    q.version            = results_version;
+    q.generator_version  = bsp_layout::generator_version;
+    q.random_engine      = random_engine_id();
+    q.first_seed         = 0;
+    q.seed_count         = 1000000;
+    q.width              = 64;
+    q.height             = 64;
+    q.min_rooms          = 0;
+    q.max_rooms          = std::numeric_limits<int32_t>::max();
+    q.min_stair_distance = std::numeric_limits<int32_t>::min();
+    q.max_dead_end       = std::numeric_limits<int32_t>::max();
+    q.route_corridors    = 0;
+    q.block_size         = block_size;
+
+    int  thread_count = 0;
+    bool list         = false;
+
+    for (int i = 2; i < argc; ++i) {
+        auto const is = [&](char const* const option, int const values) {
+            return !std::strcmp(argv[i], option) && i + values < argc;
+        };
+
+        auto const next = [&] { return std::strtoll(argv[++i], nullptr, 10); };
+
+        if (is("--seeds", 2)) {
+            q.first_seed = static_cast<uint32_t>(next());
+            q.seed_count = static_cast<uint64_t>(next());
+        } else if (is("--size", 2)) {
+            q.width  = static_cast<int32_t>(next());
+            q.height = static_cast<int32_t>(next());
+        } else if (is("--rooms", 2)) {
+            q.min_rooms = static_cast<int32_t>(next());
+            q.max_rooms = static_cast<int32_t>(next());
+        } else if (is("--stairs", 1)) {
+            q.min_stair_distance = static_cast<int32_t>(next());
+        } else if (is("--dead-end", 1)) {
+            q.max_dead_end = static_cast<int32_t>(next());
+        } else if (is("--threads", 1)) {
+            thread_count = static_cast<int>(next());
+        } else if (!std::strcmp(argv[i], "--routed")) {
+            q.route_corridors = 1;
+        } else if (!std::strcmp(argv[i], "--list")) {
+            list = true;
+        } else {
+            print_usage();
+            return 1;
+        }
+    }
+
+    if (q.width < map_min_size || q.height < map_min_size
+     || q.seed_count == 0 || q.first_seed + (q.seed_count - 1) > std::numeric_limits<uint32_t>::max()
+    ) {
+        std::cerr << "bad size or seed range" << std::endl;
+        return 1;
+    }
+
+    auto const blocks = block_count(q);
+
+    std::vector<bool>    done (static_cast<size_t>(blocks));
+    std::vector<match_t> found;
+    uint64_t             valid = 0;
+
+    try {
+        valid = read_results(file_name, q, done, found);
+    } catch (std::exception const& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    std::sort(found.begin(), found.end(), [](match_t const& a, match_t const& b) {
+        return a.seed < b.seed;
+    });
+
+    if (list) {
+        std::cout << std::setw(10) << "seed" << std::setw(8) << "rooms"
+                  << std::setw(8)  << "stairs" << std::setw(8) << "dead end" << "\n";
+
+        for (auto const& m : found) {
+            print_match(m);
+        }
+
+        return 0;
+    }
+
+    std::ofstream out;
+
+    try {
+        if (valid == 0) {
+            out.open(file_name, std::ios::out | std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<char const*>(&q), sizeof(q));
+        } else {
+            std::ifstream size_of {file_name, std::ios::in | std::ios::binary | std::ios::ate};
+            if (static_cast<uint64_t>(size_of.tellg()) != valid) {
+                size_of.close();
+                truncate_results(file_name, valid);
+            }
+
+            out.open(file_name, std::ios::out | std::ios::binary | std::ios::app);
+        }
+    } catch (std::exception const& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    if (!out) {
+        std::cerr << "couldn't open \"" << file_name << "\" for writing" << std::endl;
+        return 1;
+    }
+
+    auto const remaining = static_cast<uint64_t>(std::count(done.begin(), done.end(), false));
+    std::cerr << blocks - remaining << " of " << blocks << " blocks already searched, "
+              << found.size() << " matches" << std::endl;
+
+    bsp_layout::params_t params;
+    params.map_w           = q.width;
+    params.map_h           = q.height;
+    params.route_corridors = q.route_corridors != 0;
+
+    auto const threads = thread_count > 0
+      ? thread_count
+      : std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+    std::atomic<uint64_t> next_block {0};
+    std::atomic<uint64_t> searched {0};
+    std::atomic<uint64_t> matched {found.size()};
+    std::mutex            out_mutex;
+    bool                  failed = false;
+
+    auto const start = std::chrono::steady_clock::now();
+
+    auto const worker = [&] {
+        bsp_layout     layout {params};
+        level_analyzer analyzer;
+        map            m {params.map_w, params.map_h};
+
+        std::vector<match_t> block_matches;
+
+        for (auto b = next_block++; b < blocks; b = next_block++) {
+            if (done[static_cast<size_t>(b)]) {
+                continue;
+            }
+
+            block_matches.clear();
+
+            auto const first = q.first_seed + static_cast<uint32_t>(b * block_size);
+            auto const count = static_cast<uint32_t>(std::min<uint64_t>(block_size, q.seed_count - b * block_size));
+
+            for (uint32_t i = 0; i < count; ++i) {
+                auto const seed = first + i;
+
+                random_t random {seed};
+                layout.generate_into(m, random);
+
+                auto const metrics    = analyzer.analyze(m);
+                auto const room_count = static_cast<int>(layout.get_rooms().size());
+
+                if (matches(q, room_count, metrics)) {
+                    block_matches.push_back(match_t {
+                        seed, room_count, metrics.stair_distance, metrics.longest_dead_end
+                    });
+                }
+            }
+
+            block_header const header {b, static_cast<uint32_t>(block_matches.size()), 0};
+
+            //a block and its matches are written and flushed together
+            std::lock_guard<std::mutex> lock {out_mutex};
+
+            out.write(reinterpret_cast<char const*>(&header), sizeof(header));
+            out.write(reinterpret_cast<char const*>(block_matches.data())
+                    , static_cast<std::streamsize>(sizeof(match_t) * block_matches.size()));
+            out.flush();
+
+            if (!out) {
+                failed = true;
+                next_block = blocks;
+                return;
+            }
+
+            for (auto const& match : block_matches) {
+                print_match(match);
+            }
+
+            searched += count;
+            matched  += block_matches.size();
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (int i = 1; i < threads; ++i) {
+        workers.emplace_back(worker);
+    }
+
+    worker();
+
+    for (auto& w : workers) {
+        w.join();
+    }
+
+    std::cout.flush();
+
+    if (failed) {
+        std::cerr << "couldn't write \"" << file_name << "\"" << std::endl;
+        return 1;
+    }
+
+    auto const seconds = std::chrono::duration<double> {std::chrono::steady_clock::now() - start}.count();
+    auto const rate    = seconds > 0.0 ? static_cast<double>(searched) / seconds : 0.0;
+
+    std::cerr << searched << " seeds in " << std::fixed << std::setprecision(1) << seconds << " s on "
+              << threads << " threads (" << std::setprecision(2) << rate * 3600.0 / 1.0e6
+              << " M seeds/hour), " << matched << " matches" << std::endl;
+
+    return 0;
+}